@@ -28,10 +28,23 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 struct kiss_fft_state{
     int nfft;
     int inverse;
+    int simd; /* KISS_FFT_SIMD_NONE, _SSE2 or _AVX2, resolved at alloc time */
     int factors[2*MAXFACTORS];
+    /* offset (past the nfft twiddles) of each stage's twiddles laid out
+       contiguously for the SIMD butterflies, -1 if the stage has none */
+    int stage_twiddles[MAXFACTORS];
     kiss_fft_cpx twiddles[1];
 };
 
+/* The SSE2/AVX2 butterflies work on the interleaved float layout only, so
+   they are left out of fixed point and USE_SIMD (__m128 scalar) builds. */
+#if !defined(FIXED_POINT) && !defined(USE_SIMD) && defined(__GNUC__) \
+    && (defined(__x86_64__) || defined(__i386__))
+# define KISS_FFT_X86_SIMD
+# include <immintrin.h>
+# include <cpuid.h>
+#endif
+
 /*
   Explanation of macros dealing with complex math:
 
@@ -0,0 +1,208 @@
+/*
+Copyright (c) 2003-2010, Mark Borgerding
+
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * Neither the author nor the names of any contributors may be used to endorse or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+ * Frame-parallel real FFT used by kiss_fftr_batch.
+ *
+ * KFB_W frames are transposed so that lane j of every vector belongs to
+ * frame j. The transform then runs the usual kiss recursion (same factors,
+ * same twiddles, broadcast to all lanes) where every scalar operation is a
+ * vector operation, so even the short inner stages use the full width.
+ *
+ * kiss_fftr.c includes this file once per instruction set with
+ *   KFB_W         frames per vector
+ *   KFB_TARGET    function attribute enabling the instruction set
+ *   KFB_NAME(x)   name mangling for the generated functions
+ * defined. Only radix 2, 4 and 8 stages are supported, see kfb_supported().
+ */
+
+typedef float KFB_NAME(vec) __attribute__((vector_size(KFB_W*4)));
+typedef struct { KFB_NAME(vec) r, i; } KFB_NAME(cpx);
+
+#define KFB_VEC KFB_NAME(vec)
+#define KFB_CPX KFB_NAME(cpx)
+
+static KFB_TARGET void KFB_NAME(bfly2)(KFB_CPX * Fout, const size_t fstride, const kiss_fft_cfg st, int m)
+{
+    const kiss_fft_cpx * tw = st->twiddles;
+    int k;
+    for (k=0;k<m;++k) {
+        KFB_CPX t, * Fout2 = Fout + m + k;
+        t.r = Fout2->r*tw->r - Fout2->i*tw->i;
+        t.i = Fout2->r*tw->i + Fout2->i*tw->r;
+        tw += fstride;
+        Fout2->r = Fout[k].r - t.r;  Fout2->i = Fout[k].i - t.i;
+        Fout[k].r += t.r;            Fout[k].i += t.i;
+    }
+}
+
+static KFB_TARGET void KFB_NAME(bfly4)(KFB_CPX * Fout, const size_t fstride, const kiss_fft_cfg st, int m)
+{
+    const kiss_fft_cpx *tw1,*tw2,*tw3;
+    const float rot = st->inverse ? -1.f : 1.f;
+    int k;
+    tw3 = tw2 = tw1 = st->twiddles;
+    for (k=0;k<m;++k) {
+        KFB_CPX s0,s1,s2,s3,s4,s5;
+        KFB_CPX * F = Fout + k;
+        s0.r = F[m].r*tw1->r - F[m].i*tw1->i;       s0.i = F[m].r*tw1->i + F[m].i*tw1->r;
+        s1.r = F[2*m].r*tw2->r - F[2*m].i*tw2->i;   s1.i = F[2*m].r*tw2->i + F[2*m].i*tw2->r;
+        s2.r = F[3*m].r*tw3->r - F[3*m].i*tw3->i;   s2.i = F[3*m].r*tw3->i + F[3*m].i*tw3->r;
+        tw1 += fstride;
+        tw2 += fstride*2;
+        tw3 += fstride*3;
+
+        s5.r = F->r - s1.r;  s5.i = F->i - s1.i;
+        F->r += s1.r;        F->i += s1.i;
+        s3.r = s0.r + s2.r;  s3.i = s0.i + s2.i;
+        /* s4 = -i*(s0-s2) forward, +i*(s0-s2) inverse */
+        s4.r = (s0.i - s2.i)*rot;
+        s4.i = (s2.r - s0.r)*rot;
+
+        F[2*m].r = F->r - s3.r;  F[2*m].i = F->i - s3.i;
+        F->r += s3.r;            F->i += s3.i;
+        F[m].r = s5.r + s4.r;    F[m].i = s5.i + s4.i;
+        F[3*m].r = s5.r - s4.r;  F[3*m].i = s5.i - s4.i;
+    }
+}
+
+/* -i*z forward, +i*z inverse, rot being +1 or -1 accordingly */
+#define KFB_ROT(d, z) do { KFB_VEC zr_ = (z).r; (d).r = (z).i*rot; (d).i = -zr_*rot; } while (0)
+
+static KFB_TARGET void KFB_NAME(bfly8)(KFB_CPX * Fout, const size_t fstride, const kiss_fft_cfg st, int m)
+{
+    const float rot = st->inverse ? -1.f : 1.f;
+    const float c = 0.70710678118654752f;
+    int k, q;
+    for (k=0;k<m;++k) {
+        KFB_CPX x[8], t0, t1, t2, t3, e[4], o[4];
+        KFB_CPX * F = Fout + k;
+        x[0] = F[0];
+        for (q=1;q<8;++q) {
+            const kiss_fft_cpx tw = st->twiddles[q*k*fstride];
+            x[q].r = F[q*m].r*tw.r - F[q*m].i*tw.i;
+            x[q].i = F[q*m].r*tw.i + F[q*m].i*tw.r;
+        }
+
+        /* two radix-4 DFTs of the even and odd inputs, as in kf_bfly8 */
+        for (q=0;q<2;++q) {
+            KFB_CPX * d = q ? o : e;
+            const KFB_CPX * a = x + q;
+            t0.r = a[0].r + a[4].r;  t0.i = a[0].i + a[4].i;
+            t1.r = a[0].r - a[4].r;  t1.i = a[0].i - a[4].i;
+            t2.r = a[2].r + a[6].r;  t2.i = a[2].i + a[6].i;
+            t3.r = a[2].r - a[6].r;  t3.i = a[2].i - a[6].i;
+            KFB_ROT(t3, t3);
+            d[0].r = t0.r + t2.r;  d[0].i = t0.i + t2.i;
+            d[2].r = t0.r - t2.r;  d[2].i = t0.i - t2.i;
+            d[1].r = t1.r + t3.r;  d[1].i = t1.i + t3.i;
+            d[3].r = t1.r - t3.r;  d[3].i = t1.i - t3.i;
+        }
+
+        /* o[q] *= W8^q */
+        KFB_ROT(t0, o[1]);
+        o[1].r = (o[1].r + t0.r)*c;  o[1].i = (o[1].i + t0.i)*c;
+        KFB_ROT(o[2], o[2]);
+        KFB_ROT(t0, o[3]);
+        o[3].r = (t0.r - o[3].r)*c;  o[3].i = (t0.i - o[3].i)*c;
+
+        for (q=0;q<4;++q) {
+            F[q*m].r = e[q].r + o[q].r;      F[q*m].i = e[q].i + o[q].i;
+            F[(q+4)*m].r = e[q].r - o[q].r;  F[(q+4)*m].i = e[q].i - o[q].i;
+        }
+    }
+}
+
+static KFB_TARGET void KFB_NAME(work)(KFB_CPX * Fout, const KFB_CPX * f, const size_t fstride,
+        const int * factors, const kiss_fft_cfg st)
+{
+    KFB_CPX * Fout_beg = Fout;
+    const int p=*factors++;
+    const int m=*factors++;
+    const KFB_CPX * Fout_end = Fout + p*m;
+
+    if (m==1) {
+        do{
+            *Fout = *f;
+            f += fstride;
+        }while(++Fout != Fout_end);
+    }else{
+        do{
+            KFB_NAME(work)(Fout, f, fstride*p, factors, st);
+            f += fstride;
+        }while( (Fout += m) != Fout_end );
+    }
+
+    Fout=Fout_beg;
+    if (p==8)
+        KFB_NAME(bfly8)(Fout,fstride,st,m);
+    else if (p==4)
+        KFB_NAME(bfly4)(Fout,fstride,st,m);
+    else
+        KFB_NAME(bfly2)(Fout,fstride,st,m);
+}
+
+/*
+ * Transform frames [0, KFB_W) starting at timedata. scratch holds
+ * 2*ncfft KFB_CPX and is suitably aligned.
+ */
+static KFB_TARGET void KFB_NAME(frames)(kiss_fftr_cfg st, const kiss_fft_scalar * timedata,
+        kiss_fft_cpx * freqdata, int in_stride, int out_stride, void * scratch)
+{
+    const int ncfft = st->substate->nfft;
+    KFB_CPX * packed = (KFB_CPX *) scratch;
+    KFB_CPX * spec = packed + ncfft;
+    int j, k;
+
+    /* transpose, packing even/odd samples into real/imag like kiss_fftr */
+    for (k=0;k<ncfft;++k)
+        for (j=0;j<KFB_W;++j) {
+            packed[k].r[j] = timedata[j*in_stride + 2*k];
+            packed[k].i[j] = timedata[j*in_stride + 2*k + 1];
+        }
+
+    KFB_NAME(work)(spec, packed, 1, st->substate->factors, st->substate);
+
+    for (j=0;j<KFB_W;++j) {
+        kiss_fft_cpx * out = freqdata + j*out_stride;
+        out[0].r = spec[0].r[j] + spec[0].i[j];
+        out[ncfft].r = spec[0].r[j] - spec[0].i[j];
+        out[0].i = out[ncfft].i = 0;
+    }
+
+    /* split the packed spectrum, then transpose back */
+    for (k=1;k<=ncfft/2;++k) {
+        const kiss_fft_cpx tw = st->super_twiddles[k-1];
+        KFB_CPX fpk = spec[k], fpnk, f1k, f2k, t, lo, hi;
+        fpnk.r = spec[ncfft-k].r;
+        fpnk.i = -spec[ncfft-k].i;
+
+        f1k.r = fpk.r + fpnk.r;  f1k.i = fpk.i + fpnk.i;
+        f2k.r = fpk.r - fpnk.r;  f2k.i = fpk.i - fpnk.i;
+        t.r = f2k.r*tw.r - f2k.i*tw.i;
+        t.i = f2k.r*tw.i + f2k.i*tw.r;
+
+        lo.r = (f1k.r + t.r)*.5f;  lo.i = (f1k.i + t.i)*.5f;
+        hi.r = (f1k.r - t.r)*.5f;  hi.i = (t.i - f1k.i)*.5f;
+        for (j=0;j<KFB_W;++j) {
+            kiss_fft_cpx * out = freqdata + j*out_stride;
+            out[k].r = lo.r[j];        out[k].i = lo.i[j];
+            out[ncfft-k].r = hi.r[j];  out[ncfft-k].i = hi.i[j];
+        }
+    }
+}
+
+#undef KFB_ROT
+#undef KFB_VEC
+#undef KFB_CPX
@@ -0,0 +1,108 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: cepstrum.cpp
+ Description:
+ Real cepstrum of a frame from its forward spectrum, cepstral
+ coefficients and a quefrency peak pitch estimate.
+
+ c[q] = 1/N sum_k ln|X_k| e^(j2pi kq/N), the log magnitude taken from the
+ spectrum the frame was drawn from and sent through the inverse real
+ FFT. Harmonics f0 apart give a peak at q = fs/f0. The harmonics must be
+ resolved by the window for the peak to show, the Kaiser window of the
+ spectogram merges them below roughly 13 bins of spacing.
+
+ The fixed point build stays in integers: ln|X| comes from power_to_db_q8
+ in Q11, and the fixed kiss_fftri already scales by 1/N.
+ */
+
+#include <iostream>
+#include <math.h>
+#include <limits.h>
+#include <algorithm>
+
+#include "cepstrum.h"
+#include "common.h"
+
+using namespace std;
+
+// A quefrency peak below this (natural log units) is taken as unvoiced
+#define CEPSTRUM_VOICED 0.08f
+
+cepstrum::cepstrum(int _nfft, double _sampleRate, int ncoeffs, float minPitch, float maxPitch) :
+    nfft(_nfft), sampleRate(_sampleRate), logmag(_nfft / 2 + 1), ceps(_nfft),
+    coeffs(std::min(ncoeffs, _nfft / 2)), f0(0)
+{
+    qmin = std::max(2, (int)ceil(sampleRate / maxPitch));
+    qmax = std::min(nfft / 2 - 2, (int)floor(sampleRate / minPitch));
+    scaled.resize(std::max(qmax + 2, (int)coeffs.size()));
+
+    inv = fftPlan::get(nfft, true);
+    if (!inv) {
+        cerr << "[Error] Not enough memory!" << endl;
+        exit(-1);
+    }
+} /* cepstrum::cepstrum */
+
+void
+cepstrum::process(const kiss_fft_cpx* spec)
+{
+    const int nbins = nfft / 2 + 1;
+    float* c = &scaled[0];
+
+#ifdef FIXED_POINT
+    // ln|X| = 10log10(power) ln(10)/20, Q8 dB to Q11 nepers
+    for (int k = 0; k < nbins; k++) {
+        unsigned int power = (unsigned int)(spec[k].r * spec[k].r) +
+                             (unsigned int)(spec[k].i * spec[k].i);
+        int db_q8 = power_to_db_q8(power);
+        logmag[k].r = db_q8 == INT_MIN ? 0 : (kiss_fft_scalar)((db_q8 * 60361) >> 16);
+        logmag[k].i = 0;
+    }
+    inv->inverse(&logmag[0], &ceps[0]);
+    for (size_t q = 0; q < scaled.size(); q++)
+        c[q] = ceps[q] / 2048.f;
+    // the fixed spectrum is the float one times 32768/nfft
+    c[0] -= logf(32768.f / nfft);
+#else
+    for (int k = 0; k < nbins; k++) {
+        float power = spec[k].r * spec[k].r + spec[k].i * spec[k].i;
+        logmag[k].r = 0.5f * logf(std::max(power, 1e-30f));
+        logmag[k].i = 0;
+    }
+    inv->inverse(&logmag[0], &ceps[0]);
+    for (size_t q = 0; q < scaled.size(); q++)
+        c[q] = ceps[q] / nfft;
+#endif
+
+    for (size_t i = 0; i < coeffs.size(); i++)
+        coeffs[i] = c[i];
+
+    // Highest cepstral peak in the pitch range, refined by a parabola
+    int best = qmin;
+    for (int q = qmin + 1; q <= qmax; q++)
+        if (c[q] > c[best])
+            best = q;
+
+    f0 = 0;
+    if (c[best] > CEPSTRUM_VOICED) {
+        float a = c[best - 1], b = c[best], d = c[best + 1];
+        float denom = a - 2 * b + d;
+        float offset = denom < 0 ? 0.5f * (a - d) / denom : 0;
+        f0 = (float)(sampleRate / (best + offset));
+    }
+} /* cepstrum::process */
@@ -0,0 +1,62 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: cepstrum.h
+ Description:
+ Real cepstrum of a frame from its forward spectrum, cepstral
+ coefficients and a quefrency peak pitch estimate.
+ */
+
+#ifndef CEPSTRUM_H
+#define CEPSTRUM_H
+
+#include <vector>
+
+// kissFFT addon include file
+#include "kiss_fft.h"
+#include "fftPlan.h"
+
+class cepstrum
+{
+public:
+    // nfft: frame length, ncoeffs: coefficients kept, pitch searched in
+    // [minPitch, maxPitch] Hz
+    cepstrum(int nfft, double sampleRate, int ncoeffs = 13,
+             float minPitch = 80, float maxPitch = 1000);
+
+    // spec: the nfft/2+1 bins of the frame's forward FFT, as drawn
+    void process(const kiss_fft_cpx* spec);
+
+    int size() const { return (int)coeffs.size(); }
+    // c0..c(ncoeffs-1), on the float spectrum scale in both builds
+    const float* coefficients() const { return &coeffs[0]; }
+    // Fundamental in Hz, 0 when no quefrency peak stands out
+    float pitch() const { return f0; }
+
+private:
+    int nfft;
+    double sampleRate;
+    int qmin, qmax;             // quefrency search range, samples
+    fftr_plan inv;
+    std::vector<kiss_fft_cpx> logmag;
+    std::vector<kiss_fft_scalar> ceps;
+    std::vector<float> scaled;  // ceps up to qmax+1 on the float scale
+    std::vector<float> coeffs;
+    float f0;
+};
+
+#endif
@@ -12,9 +12,10 @@
 #define MIN(x,y)		((x) < (y) ? (x) : (y))
 #endif
 
-float linestep (float x, float min, float max);
-void apply_window (float* out, const float* data, int datalen);
-void interp_spec (float* mag, int maglen, const float* spec, int speclen);
+// The templates are instantiated for float and double in common.cpp
+template <typename T> T linestep (T x, T min, T max);
+int power_to_db_q8 (unsigned int power);
+template <typename T> void interp_spec (T* mag, int maglen, const T* spec, int speclen);
 
 #endif
 
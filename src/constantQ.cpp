@@ -0,0 +1,241 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: constantQ.cpp
+ Description:
+ Streaming constant-Q transform, Brown-Puckette sparse spectral kernels
+ over an octave by octave decimated signal.
+
+ A bin at f with Q = 1/(2^(1/B) - 1) is the inner product of the frame
+ with a windowed e^(j2pi f n/fs) of Q fs/f samples. By Parseval that is
+     X_cq = sum_j X_j conj(K_j) / nfft
+ with K the FFT of the temporal kernel, which is only significant
+ around f. The kernels are transformed once and all but that run of
+ bins is dropped, so a frame costs one real FFT plus a few complex
+ multiply-adds per bin (Brown and Puckette, 1992).
+
+ Only the top octave's kernels are built. Each lower octave runs the
+ same nfft point FFT and kernels on the signal half-band filtered and
+ decimated once more, where a direct kernel would be 2^octave times
+ longer. Lower octaves also need transforming less often: an octave
+ waits for as many new samples at its own rate as the top one.
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <math.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "constantQ.h"
+#include "kissfft.hh"
+
+// half-band decimation lowpass, flat within 0.002dB up to 1/8 of the rate
+// and 74dB down from 3/8 on: with the top bin below a quarter of the rate,
+// each octave down is passed and its aliases are kept out
+#define HALFBAND_TAPS 23
+// kernel bins below this fraction of the kernel's peak are dropped, past
+// the Hamming sidelobes; costs under 0.03dB at the bin centres
+#define KERNEL_THRESHOLD 1e-2
+
+using namespace std;
+
+constantQ::constantQ(int _nfft, int _bins, int _binsPerOctave, double fmin, double sampleRate,
+                     double gain) :
+    nfft(_nfft), bins(_bins), binsPerOctave(_binsPerOctave),
+    octaves(_binsPerOctave > 0 ? _bins / _binsPerOctave : 0),
+    freqs(_bins), halfband(HALFBAND_TAPS), first(_binsPerOctave), length(_binsPerOctave),
+    offset(_binsPerOctave), oct(octaves), fft(_nfft), frame(_nfft), spec(_nfft),
+    values(_bins, cpx(0, 0))
+{
+    if (octaves < 1 || bins % binsPerOctave != 0) {
+        cerr << "[Error] Constant-Q bins must be whole octaves" << endl;
+        exit(-1);
+    }
+
+    const double Q = 1 / (pow(2.0, 1.0 / binsPerOctave) - 1);
+    for (int i = 0; i < bins; i++)
+        freqs[i] = (float)(fmin * pow(2.0, (double)i / binsPerOctave));
+    // the top octave is at the full rate
+    const double ftop = fmin * pow(2.0, octaves - 1);
+    if (freqs[bins - 1] >= sampleRate / 4 || Q * sampleRate / ftop > nfft) {
+        cerr << "[Error] Constant-Q octaves do not fit the sample rate and frame size" << endl;
+        exit(-1);
+    }
+
+    // Blackman windowed sinc at a quarter of the rate, unity DC gain
+    double sum = 0;
+    for (int n = 0; n < HALFBAND_TAPS; n++) {
+        double t = n - (HALFBAND_TAPS - 1) / 2.0;
+        double x = 2 * M_PI * n / (HALFBAND_TAPS - 1);
+        double sinc = t == 0 ? 0.5 : sin(M_PI * t / 2) / (M_PI * t);
+        halfband[n] = (float)(sinc * (0.42 - 0.5 * cos(x) + 0.08 * cos(2 * x)));
+        sum += halfband[n];
+    }
+    for (int n = 0; n < HALFBAND_TAPS; n++)
+        halfband[n] = (float)(halfband[n] / sum);
+
+    // Spectral kernels of the top octave. The temporal kernel is a Hamming
+    // windowed complex exponential ending with the frame, so every bin
+    // looks at the latest samples, scaled to gain/2 for a unit sinusoid.
+    kissfft<double> kfft(nfft, false);
+    std::vector<std::complex<double> > t(nfft), K(nfft);
+    const int half = nfft / 2 + 1;
+    for (int k = 0; k < binsPerOctave; k++) {
+        const double f = ftop * pow(2.0, (double)k / binsPerOctave);
+        const int len = (int)ceil(Q * sampleRate / f);
+        const int start = nfft - len;
+
+        std::fill(t.begin(), t.end(), std::complex<double>(0, 0));
+        double wsum = 0;
+        for (int n = 0; n < len; n++)
+            wsum += 0.54 - 0.46 * cos(2 * M_PI * n / (len - 1));
+        for (int n = 0; n < len; n++) {
+            double w = (0.54 - 0.46 * cos(2 * M_PI * n / (len - 1))) * gain / wsum;
+            double phase = 2 * M_PI * fmod(f / sampleRate * (start + n), 1.0);
+            t[start + n] = std::complex<double>(w * cos(phase), w * sin(phase));
+        }
+        kfft.transform(&t[0], &K[0]);
+
+        // real frames only have the bins up to nfft/2, the kernel's part
+        // above that is negligible
+        double peak = 0;
+        for (int j = 0; j < half; j++)
+            peak = std::max(peak, std::abs(K[j]));
+        int a = 0, e = half - 1;
+        while (std::abs(K[a]) < KERNEL_THRESHOLD * peak)
+            a++;
+        while (std::abs(K[e]) < KERNEL_THRESHOLD * peak)
+            e--;
+        // even length for the two bins per SSE2 step, kept inside the bins
+        int n = std::min((e - a + 2) & ~1, half & ~1);
+        a = std::max(0, std::min(a, half - n));
+        first[k] = a;
+        length[k] = n;
+        offset[k] = (int)weights.size();
+        for (int j = a; j < a + n; j++) {
+            std::complex<double> w = std::conj(K[j]) / (double)nfft;
+            weights.push_back(cpx((float)w.real(), (float)w.imag()));
+        }
+    }
+
+    for (int o = 0; o < octaves; o++) {
+        oct[o].ring.assign(nfft, 0);
+        oct[o].pos = oct[o].fresh = 0;
+        oct[o].delay.assign(2 * HALFBAND_TAPS, 0);
+        oct[o].dpos = 0;
+        oct[o].odd = false;
+    }
+} /* constantQ::constantQ */
+
+void
+constantQ::push(int o, float x)
+{
+    octave& oc = oct[o];
+    oc.ring[oc.pos] = x;
+    if (++oc.pos == nfft)
+        oc.pos = 0;
+    oc.fresh++;
+    if (o + 1 == octaves)
+        return;
+
+    // the delay line is stored twice, so the last TAPS samples always sit
+    // in one piece; every other filtered sample goes down an octave
+    oc.delay[oc.dpos] = oc.delay[oc.dpos + HALFBAND_TAPS] = x;
+    if (++oc.dpos == HALFBAND_TAPS)
+        oc.dpos = 0;
+    oc.odd = !oc.odd;
+    if (oc.odd)
+        return;
+    const float* d = &oc.delay[oc.dpos];
+    const float* h = &halfband[0];
+    float y = 0;
+    // the half-band's odd taps off the centre are zero
+    for (int n = 0; n < HALFBAND_TAPS; n += 2)
+        y += d[n] * h[n];
+    y += d[HALFBAND_TAPS / 2] * h[HALFBAND_TAPS / 2];
+    push(o + 1, y);
+} /* constantQ::push */
+
+void
+constantQ::transform(int o)
+{
+    octave& oc = oct[o];
+    std::copy(oc.ring.begin() + oc.pos, oc.ring.end(), frame.begin());
+    std::copy(oc.ring.begin(), oc.ring.begin() + oc.pos, frame.begin() + nfft - oc.pos);
+    fft.forward(&frame[0], &spec[0]);
+    oc.fresh = 0;
+
+    // octave o holds the bins from the top down
+    cpx* v = &values[(octaves - 1 - o) * binsPerOctave];
+    for (int k = 0; k < binsPerOctave; k++) {
+        const float* x = (const float*)&spec[first[k]];
+        const float* w = (const float*)&weights[offset[k]];
+        const int n = 2 * length[k];
+        float re, im;
+#if defined(__SSE2__)
+        // two bins a step: xw sums to re+re', x times the swapped w to im
+        __m128 xw = _mm_setzero_ps(), xs = _mm_setzero_ps();
+        for (int j = 0; j < n; j += 4) {
+            __m128 a = _mm_loadu_ps(x + j), b = _mm_loadu_ps(w + j);
+            xw = _mm_add_ps(xw, _mm_mul_ps(a, b));
+            xs = _mm_add_ps(xs, _mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 3, 0, 1))));
+        }
+        float p[4], q[4];
+        _mm_storeu_ps(p, xw);
+        _mm_storeu_ps(q, xs);
+        re = (p[0] + p[2]) - (p[1] + p[3]);
+        im = (q[0] + q[1]) + (q[2] + q[3]);
+#else
+        re = im = 0;
+        for (int j = 0; j < n; j += 2) {
+            re += x[j] * w[j] - x[j + 1] * w[j + 1];
+            im += x[j] * w[j + 1] + x[j + 1] * w[j];
+        }
+#endif
+        v[k] = cpx(re, im);
+    }
+} /* constantQ::transform */
+
+void
+constantQ::process(const kiss_fft_scalar* samples, int n, kiss_fft_cpx* out)
+{
+    for (int i = 0; i < n; i++)
+#ifdef FIXED_POINT
+        // same full scale as the float samples
+        push(0, samples[i] * (1.0f / 32768));
+#else
+        push(0, samples[i]);
+#endif
+
+    for (int o = 0; o < octaves; o++)
+        if (oct[o].fresh >= n)
+            transform(o);
+
+    for (int i = 0; i < bins; i++) {
+#ifdef FIXED_POINT
+        // fixed point kiss_fftr output is scaled by 32768/nfft
+        cpx x = values[i] * (32768.0f / nfft);
+        out[i].r = (kiss_fft_scalar)std::max(-32768.f, std::min(32767.f, x.real()));
+        out[i].i = (kiss_fft_scalar)std::max(-32768.f, std::min(32767.f, x.imag()));
+#else
+        out[i].r = values[i].real();
+        out[i].i = values[i].imag();
+#endif
+    }
+} /* constantQ::process */
@@ -0,0 +1,85 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: constantQ.h
+ Description:
+ Streaming constant-Q transform, Brown-Puckette sparse spectral kernels
+ over an octave by octave decimated signal.
+ */
+
+#ifndef CONSTANTQ_H
+#define CONSTANTQ_H
+
+#include <vector>
+#include <complex>
+
+// kissFFT addon include file
+#include "kiss_fft.h"
+#include "spectrumPipeline.h"
+
+class constantQ
+{
+public:
+    // bins log spaced bins, binsPerOctave to an octave (bins a multiple of
+    // it) from fmin Hz up, over frames of nfft samples at every octave's
+    // rate. gain is the sum of the window a kiss_fftr frame would have, so
+    // that the bins come out on the same scale as its output.
+    constantQ(int nfft, int bins, int binsPerOctave, double fmin, double sampleRate,
+              double gain);
+
+    int size() const { return bins; }
+    // centre frequency of a bin, Hz
+    float frequency(int bin) const { return freqs[bin]; }
+
+    // Take in n new samples and write all bins to out, scaled like
+    // kiss_fftr output. An octave is transformed again once it has taken
+    // in n samples at its own rate, lower ones keep their last value.
+    void process(const kiss_fft_scalar* samples, int n, kiss_fft_cpx* out);
+
+private:
+    typedef std::complex<float> cpx;
+
+    // one octave: the last nfft samples at its rate and the half-band
+    // decimator state feeding the next octave down
+    struct octave {
+        std::vector<float> ring;
+        int pos, fresh;
+        std::vector<float> delay;   // TAPS samples, stored twice
+        int dpos;
+        bool odd;
+    };
+
+    void push(int o, float x);
+    void transform(int o);
+
+    int nfft, bins, binsPerOctave, octaves;
+    std::vector<float> freqs;
+    std::vector<float> halfband;    // decimation lowpass
+
+    // sparse spectral kernels of the top octave, shared by every octave:
+    // a run of conj(K)/nfft from its first bin on, even length
+    std::vector<int> first, length, offset;
+    std::vector<cpx> weights;
+
+    std::vector<octave> oct;
+    pipelineFFT<float> fft;
+    std::vector<float> frame;
+    std::vector<cpx> spec;
+    std::vector<cpx> values;        // latest value of every bin
+};
+
+#endif
@@ -0,0 +1,153 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: fastFIR.cpp
+ Description:
+ Streaming FIR filter by overlap-save FFT convolution.
+
+ Each transform takes the last ntaps-1 input samples followed by up to
+ block new ones, zero padded to nfft. It multiplies their spectrum with
+ the spectrum of the taps and transforms back. The outputs from
+ ntaps-1 on are free of circular wrap-around and are the filtered
+ block. That costs two real FFTs per block, O(log nfft) per sample
+ against ntaps multiply-adds for a direct form filter. The output is
+ not delayed beyond the filter's own response.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <algorithm>
+
+#include "fastFIR.h"
+
+using namespace std;
+
+fastFIR::fastFIR(const std::vector<float>& taps, int blockHint) :
+    ntaps((int)taps.size()),
+    nfft(kiss_fftr_next_fast_size_real(ntaps - 1 + std::max(blockHint, ntaps))),
+    block(nfft - ntaps + 1), frame(nfft, 0), result(nfft)
+#ifdef FIXED_POINT
+    , fwd(nfft, false), inv(nfft, true), cframe(nfft)
+#endif
+{
+#ifdef FIXED_POINT
+    filter.resize(nfft);
+    spec.resize(nfft);
+    for (int n = 0; n < nfft; n++)
+        cframe[n] = n < ntaps ? taps[n] : 0;
+    fwd.transform(&cframe[0], &filter[0]);
+#else
+    fwd = fftPlan::get(nfft, false);
+    inv = fftPlan::get(nfft, true);
+    if (!fwd || !inv) {
+        cerr << "[Error] Not enough memory!" << endl;
+        exit(-1);
+    }
+    filter.resize(nfft / 2 + 1);
+    spec.resize(nfft / 2 + 1);
+    std::vector<float> padded(nfft, 0);
+    std::copy(taps.begin(), taps.end(), padded.begin());
+    fwd->forward(&padded[0], (kiss_fft_cpx*)&filter[0]);
+#endif
+    // the inverse transform is unnormalized
+    for (size_t k = 0; k < filter.size(); k++)
+        filter[k] /= (float)nfft;
+} /* fastFIR::fastFIR */
+
+bool
+fastFIR::loadTaps(const char* filename, std::vector<float>& taps)
+{
+    std::ifstream file(filename);
+    if (!file)
+        return false;
+
+    taps.clear();
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line[0] == '#')
+            continue;
+        std::istringstream fields(line);
+        float tap;
+        while (fields >> tap)
+            taps.push_back(tap);
+    }
+    return !taps.empty();
+} /* fastFIR::loadTaps */
+
+void
+fastFIR::reset()
+{
+    std::fill(frame.begin(), frame.end(), 0.f);
+} /* fastFIR::reset */
+
+void
+fastFIR::process(const kiss_fft_scalar* in, kiss_fft_scalar* out, int count)
+{
+    const int hist = ntaps - 1;
+
+    for (int done = 0; done < count; ) {
+        const int len = std::min(block, count - done);
+        // all of this block is read before any of it is written, in may be out
+        std::copy(in + done, in + done + len, frame.begin() + hist);
+        std::fill(frame.begin() + hist + len, frame.end(), 0.f);
+
+        convolve();
+
+        for (int n = 0; n < len; n++) {
+#ifdef FIXED_POINT
+            float y = floorf(result[hist + n] + 0.5f);
+            out[done + n] = (kiss_fft_scalar)std::max(-32768.f, std::min(32767.f, y));
+#else
+            out[done + n] = result[hist + n];
+#endif
+        }
+
+        // the last ntaps-1 inputs are the history of the next block
+        std::copy(frame.begin() + len, frame.begin() + len + hist, frame.begin());
+        done += len;
+    }
+} /* fastFIR::process */
+
+void
+fastFIR::convolve()
+{
+#ifdef FIXED_POINT
+    for (int n = 0; n < nfft; n++)
+        cframe[n] = frame[n];
+    fwd.transform(&cframe[0], &spec[0]);
+#else
+    fwd->forward(&frame[0], (kiss_fft_cpx*)&spec[0]);
+#endif
+
+    // plain complex products, std::complex's operator* is NaN/inf aware
+    // and much slower
+    for (size_t k = 0; k < spec.size(); k++) {
+        float re = spec[k].real() * filter[k].real() - spec[k].imag() * filter[k].imag();
+        float im = spec[k].real() * filter[k].imag() + spec[k].imag() * filter[k].real();
+        spec[k] = std::complex<float>(re, im);
+    }
+
+#ifdef FIXED_POINT
+    inv.transform(&spec[0], &cframe[0]);
+    for (int n = 0; n < nfft; n++)
+        result[n] = cframe[n].real();
+#else
+    inv->inverse((const kiss_fft_cpx*)&spec[0], &result[0]);
+#endif
+} /* fastFIR::convolve */
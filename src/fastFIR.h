@@ -0,0 +1,70 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: fastFIR.h
+ Description:
+ Streaming FIR filter by overlap-save FFT convolution.
+ */
+
+#ifndef FASTFIR_H
+#define FASTFIR_H
+
+#include <vector>
+#include <complex>
+
+// kissFFT addon include file
+#include "kiss_fft.h"
+#ifdef FIXED_POINT
+#include "kissfft.hh"
+#else
+#include "fftPlan.h"
+#endif
+
+class fastFIR
+{
+public:
+    // taps: impulse response. blockHint: usual number of samples per
+    // process call, the FFT is sized so such a call takes one transform.
+    fastFIR(const std::vector<float>& taps, int blockHint);
+
+    // Read taps from a text file, whitespace separated, '#' starts a
+    // comment line. Returns false if it cannot be read or has no taps.
+    static bool loadTaps(const char* filename, std::vector<float>& taps);
+
+    // Filter count samples, the filter state carries over between calls
+    // so consecutive calls are one continuous stream. in and out may be
+    // the same buffer.
+    void process(const kiss_fft_scalar* in, kiss_fft_scalar* out, int count);
+    void reset();
+
+private:
+    void convolve();
+
+    int ntaps, nfft, block;     // block: new samples per transform
+    std::vector<float> frame;   // ntaps-1 samples of history, then the block
+    std::vector<float> result;  // circular convolution of frame and taps
+    std::vector<std::complex<float> > filter, spec;
+#ifdef FIXED_POINT
+    // kiss_fft is int16 in this build, the convolution runs in float
+    kissfft<float> fwd, inv;
+    std::vector<std::complex<float> > cframe;
+#else
+    fftr_plan fwd, inv;
+#endif
+};
+
+#endif
@@ -0,0 +1,94 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: fftPlan.cpp
+ Description:
+ Process wide cache of real FFT configurations.
+ */
+
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <atomic>
+
+#include "fftPlan.h"
+#include "fftTuner.h"
+
+namespace {
+
+typedef std::tuple<int, bool, int> planKey;
+
+// Entries only hold weak references, the callers own the plans.
+std::mutex planMutex;
+std::map<planKey, std::weak_ptr<const realFFT> > planRegistry;
+
+std::atomic<int> defaultBackend(FFT_BACKEND_BUILD_DEFAULT);
+
+}
+
+fftr_plan
+fftPlan::get(int nfft, bool inverse, int backend)
+{
+    if (backend == FFT_BACKEND_DEFAULT)
+        backend = fftTuner::enabled() ? fftTuner::best(nfft, inverse) : (int)defaultBackend;
+    if (backend != FFT_BACKEND_FFTW) {
+        int level = backend & KISS_FFT_SIMD_MASK;
+        if (level == KISS_FFT_SIMD_AUTO || level > kiss_fft_simd_detect())
+            backend = (backend & ~KISS_FFT_SIMD_MASK) | kiss_fft_simd_detect();
+    }
+    planKey key(nfft, inverse, backend);
+
+    std::lock_guard<std::mutex> lock(planMutex);
+
+    std::map<planKey, std::weak_ptr<const realFFT> >::iterator it = planRegistry.find(key);
+    if (it != planRegistry.end()) {
+        fftr_plan plan = it->second.lock();
+        if (plan)
+            return plan;
+    }
+
+    // Drop the entries whose plans have all been released
+    for (it = planRegistry.begin(); it != planRegistry.end(); ) {
+        if (it->second.expired())
+            planRegistry.erase(it++);
+        else
+            ++it;
+    }
+
+    realFFT* fft = realFFT::create(nfft, inverse, backend);
+    if (fft == NULL)
+        return fftr_plan();
+
+    fftr_plan plan(fft);
+    planRegistry[key] = plan;
+    return plan;
+} /* fftPlan::get */
+
+bool
+fftPlan::setBackend(int backend)
+{
+    if (!realFFT::available(backend))
+        return false;
+    defaultBackend = backend;
+    return true;
+} /* fftPlan::setBackend */
+
+int
+fftPlan::backend()
+{
+    return defaultBackend;
+} /* fftPlan::backend */
@@ -0,0 +1,59 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: fftPlan.h
+ Description:
+ Process wide cache of real FFT configurations.
+ */
+
+#ifndef FFTPLAN_H
+#define FFTPLAN_H
+
+#include <memory>
+
+#include "realFFT.h"
+
+// Backend of fftPlan::get when none is given, kiss unless overridden at
+// build time (e.g. -DFFT_BACKEND_BUILD_DEFAULT=FFT_BACKEND_FFTW)
+#ifndef FFT_BACKEND_BUILD_DEFAULT
+#define FFT_BACKEND_BUILD_DEFAULT KISS_FFT_SIMD_AUTO
+#endif
+#define FFT_BACKEND_DEFAULT -1
+
+// A shared real FFT. It is never written after creation, so the same plan
+// may be used by several threads at once.
+typedef std::shared_ptr<const realFFT> fftr_plan;
+
+class fftPlan
+{
+public:
+    // Return the plan for (nfft, inverse, backend), building it on first use.
+    // backend is a KISS_FFT_SIMD_* level or FFT_BACKEND_FFTW, DEFAULT stands
+    // for the fftTuner choice when tuning is on, setBackend's otherwise.
+    // The kiss AUTO level is resolved before lookup so it shares plans with
+    // the level it stands for. The plan is freed when the last reference to
+    // it is dropped. Returns an empty pointer if the backend is not built in
+    // or the allocation fails.
+    static fftr_plan get(int nfft, bool inverse, int backend = FFT_BACKEND_DEFAULT);
+
+    // Process wide backend for the DEFAULT plans, set before any is built.
+    // Returns false, keeping the current one, if it is not built in.
+    static bool setBackend(int backend);
+    static int backend();
+};
+
+#endif
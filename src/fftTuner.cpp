@@ -0,0 +1,239 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: fftTuner.cpp
+ Description:
+ One time timing of the FFT backends, the fastest one per size is kept
+ in a small text file and reused by later runs on the same cpu.
+
+ File format, one result per line, '#' lines are comments:
+     <cpu> <nfft> <inverse> <backend>
+ with spaces in the cpu name replaced by '_' and backend as passed to
+ realFFT::create.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "fftTuner.h"
+#include "realFFT.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+typedef std::tuple<std::string, int, bool> tuneKey;
+
+std::mutex tuneMutex;
+std::string tuneFile;
+std::map<tuneKey, int> tuneResults;
+
+// Model name of this cpu, the key results are stored under
+std::string
+cpuName()
+{
+    std::string name;
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    unsigned int regs[12];
+    if (__get_cpuid_max(0x80000000, NULL) >= 0x80000004) {
+        for (unsigned int i = 0; i < 3; i++)
+            __get_cpuid(0x80000002 + i, &regs[4 * i], &regs[4 * i + 1],
+                        &regs[4 * i + 2], &regs[4 * i + 3]);
+        name.assign((const char*)regs, sizeof(regs));
+        name = name.c_str();
+    }
+#endif
+    // trim, and no spaces so the name is one field
+    size_t b = name.find_first_not_of(' '), e = name.find_last_not_of(' ');
+    name = b == std::string::npos ? "generic" : name.substr(b, e - b + 1);
+    std::replace(name.begin(), name.end(), ' ', '_');
+    return name;
+}
+
+// Seconds per call of op, best of a few runs long enough to time
+template <typename Op>
+double
+timeCalls(Op op)
+{
+    typedef std::chrono::steady_clock clock;
+    double best = 1e9;
+    int reps = 1;
+    for (int run = 0; run < 5; run++) {
+        clock::time_point t0 = clock::now();
+        for (int r = 0; r < reps; r++)
+            op();
+        double t = std::chrono::duration<double>(clock::now() - t0).count();
+        // grow until a run takes about a millisecond
+        if (t < 1e-3 && reps < (1 << 20)) {
+            reps *= 2;
+            run--;
+            continue;
+        }
+        best = std::min(best, t / reps);
+    }
+    return best;
+}
+
+// Seconds per frame on the calls the plan serves: inverse plans only
+// run inverse() (the FIR filter), forward plans the live windowed
+// column of the lowest nfft/4 bins and the offline batch, in equal parts.
+// The batch width follows the SIMD level, so it is timed with it.
+double
+timeBackend(int nfft, bool inverse, int backend)
+{
+    std::unique_ptr<realFFT> fft(realFFT::create(nfft, inverse, backend));
+    if (!fft)
+        return -1;
+
+    const int frames = 64;
+    std::vector<kiss_fft_scalar> timedata(nfft * frames), window(nfft);
+    std::vector<kiss_fft_cpx> freqdata((nfft / 2 + 1) * frames);
+    for (size_t i = 0; i < timedata.size(); i++)
+        timedata[i] = (kiss_fft_scalar)((i * 7919) % 61 - 30);
+    for (int i = 0; i < nfft; i++)
+        window[i] = timedata[i];
+    for (int i = 0; i <= nfft / 2; i++)
+        freqdata[i].r = freqdata[i].i = timedata[i];
+
+    realFFT* f = fft.get();
+    kiss_fft_scalar* t = &timedata[0];
+    kiss_fft_cpx* s = &freqdata[0];
+    if (inverse)
+        return timeCalls([=]() { f->inverse(s, t); });
+
+    const kiss_fft_scalar* w = &window[0];
+    double column = timeCalls([=]() { f->windowed(t, nfft / 3, w, s, nfft / 4); });
+    double batch = timeCalls([=]() { f->batch(t, s, frames, nfft, nfft / 2 + 1); }) / frames;
+    return (column + batch) / 2;
+}
+
+// Add the entries of filename that results has no value for
+void
+loadResults(const std::string& filename, std::map<tuneKey, int>& results)
+{
+    std::ifstream file(filename.c_str());
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream fields(line);
+        std::string cpu;
+        int nfft, backend;
+        bool inverse;
+        if (fields >> cpu >> nfft >> inverse >> backend)
+            results.insert(std::make_pair(tuneKey(cpu, nfft, inverse), backend));
+    }
+}
+
+// The file may be shared by other runs: their entries are merged in and
+// the new file is renamed over the old one, never rewritten in place.
+void
+saveResults()
+{
+    loadResults(tuneFile, tuneResults);
+
+    std::ostringstream tmpName;
+    tmpName << tuneFile << "." << getpid() << ".tmp";
+    {
+        std::ofstream file(tmpName.str().c_str());
+        file << "# soundScore FFT tuning: cpu nfft inverse backend" << endl;
+        for (std::map<tuneKey, int>::const_iterator it = tuneResults.begin(); it != tuneResults.end(); ++it)
+            file << std::get<0>(it->first) << " " << std::get<1>(it->first) << " "
+                 << std::get<2>(it->first) << " " << it->second << endl;
+        file.close();
+        if (!file) {
+            cerr << "[Error] Cannot write FFT tuning file : " << tmpName.str() << endl;
+            remove(tmpName.str().c_str());
+            return;
+        }
+    }
+    if (rename(tmpName.str().c_str(), tuneFile.c_str()) != 0) {
+        cerr << "[Error] Cannot replace FFT tuning file : " << tuneFile << endl;
+        remove(tmpName.str().c_str());
+    }
+}
+
+}
+
+void
+fftTuner::open(const char* filename)
+{
+    std::lock_guard<std::mutex> lock(tuneMutex);
+    tuneFile = filename;
+    tuneResults.clear();
+    loadResults(tuneFile, tuneResults);
+} /* fftTuner::open */
+
+bool
+fftTuner::enabled()
+{
+    std::lock_guard<std::mutex> lock(tuneMutex);
+    return !tuneFile.empty();
+} /* fftTuner::enabled */
+
+int
+fftTuner::best(int nfft, bool inverse)
+{
+    static const std::string cpu = cpuName();
+    tuneKey key(cpu, nfft, inverse);
+
+    std::lock_guard<std::mutex> lock(tuneMutex);
+    std::map<tuneKey, int>::const_iterator it = tuneResults.find(key);
+    if (it != tuneResults.end() && realFFT::available(it->second))
+        return it->second;
+
+    // Candidates: each kiss SIMD level with and without radix 8, and FFTW
+    std::vector<int> candidates;
+    for (int level = KISS_FFT_SIMD_NONE; level <= kiss_fft_simd_detect(); level++) {
+        candidates.push_back(level);
+        if (nfft % 8 == 0)
+            candidates.push_back(level | KISS_FFT_NO_RADIX8);
+    }
+    if (realFFT::available(FFT_BACKEND_FFTW))
+        candidates.push_back(FFT_BACKEND_FFTW);
+
+    int bestBackend = kiss_fft_simd_detect();
+    double bestTime = 1e9;
+    for (size_t i = 0; i < candidates.size(); i++) {
+        double t = timeBackend(nfft, inverse, candidates[i]);
+        if (t >= 0 && t < bestTime) {
+            bestTime = t;
+            bestBackend = candidates[i];
+        }
+    }
+    cout << "[Info] FFT tuning " << nfft << (inverse ? " inverse" : "") << " : backend "
+         << bestBackend << ", " << bestTime * 1e6 << " us" << endl;
+
+    tuneResults[key] = bestBackend;
+    saveResults();
+    return bestBackend;
+} /* fftTuner::best */
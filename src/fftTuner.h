@@ -0,0 +1,40 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: fftTuner.h
+ Description:
+ One time timing of the FFT backends, the fastest one per size is kept
+ in a small text file and reused by later runs on the same cpu.
+ */
+
+#ifndef FFTTUNER_H
+#define FFTTUNER_H
+
+class fftTuner
+{
+public:
+    // Turn tuning on, with the results kept in filename. Entries written
+    // on another cpu model are left in the file but not used.
+    static void open(const char* filename);
+    static bool enabled();
+
+    // Fastest backend for (nfft, inverse) on this cpu, timed and saved on
+    // the first request for the pair.
+    static int best(int nfft, bool inverse);
+};
+
+#endif
@@ -0,0 +1,133 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: goertzelBank.cpp
+ Description:
+ Goertzel filter bank, the spectrum level at a short list of arbitrary
+ frequencies without a full FFT.
+
+ Each frequency runs s = x + 2cos(w) s1 - s2 over the frame, after which
+ |X(w)|^2 = s1^2 + s2^2 - 2cos(w) s1 s2. Frequencies are run side
+ by side in SSE2 lanes, 16 or 32 per pass so the states stay in
+ registers for the whole frame.
+ */
+
+#include <math.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "goertzelBank.h"
+#include "common.h"
+
+#if defined(__SSE2__)
+// One Goertzel step of 4 lanes, s = (x - s2) + c s1 so only the
+// multiply-add is on the dependency chain
+#define GOERTZEL_STEP(v) \
+    do { \
+        __m128 t = _mm_add_ps(_mm_sub_ps(xi, b##v), _mm_mul_ps(c##v, a##v)); \
+        b##v = a##v; \
+        a##v = t; \
+    } while (0)
+#define GOERTZEL_LOAD(v) \
+    __m128 c##v = _mm_loadu_ps(c + 4 * v), a##v = _mm_setzero_ps(), b##v = a##v
+#define GOERTZEL_STORE(v) \
+    do { \
+        _mm_storeu_ps(s1 + 4 * v, a##v); \
+        _mm_storeu_ps(s2 + 4 * v, b##v); \
+    } while (0)
+
+// 16 frequencies over the frame, four chains keep the adder busy
+static void
+goertzel16_sse2(const float* x, int n, const float* c, float* s1, float* s2)
+{
+    GOERTZEL_LOAD(0); GOERTZEL_LOAD(1); GOERTZEL_LOAD(2); GOERTZEL_LOAD(3);
+    for (int i = 0; i < n; i++) {
+        const __m128 xi = _mm_set1_ps(x[i]);
+        GOERTZEL_STEP(0); GOERTZEL_STEP(1); GOERTZEL_STEP(2); GOERTZEL_STEP(3);
+    }
+    GOERTZEL_STORE(0); GOERTZEL_STORE(1); GOERTZEL_STORE(2); GOERTZEL_STORE(3);
+} /* goertzel16_sse2 */
+
+// 32 frequencies over the frame, throughput rather than latency bound
+static void
+goertzel32_sse2(const float* x, int n, const float* c, float* s1, float* s2)
+{
+    GOERTZEL_LOAD(0); GOERTZEL_LOAD(1); GOERTZEL_LOAD(2); GOERTZEL_LOAD(3);
+    GOERTZEL_LOAD(4); GOERTZEL_LOAD(5); GOERTZEL_LOAD(6); GOERTZEL_LOAD(7);
+    for (int i = 0; i < n; i++) {
+        const __m128 xi = _mm_set1_ps(x[i]);
+        GOERTZEL_STEP(0); GOERTZEL_STEP(1); GOERTZEL_STEP(2); GOERTZEL_STEP(3);
+        GOERTZEL_STEP(4); GOERTZEL_STEP(5); GOERTZEL_STEP(6); GOERTZEL_STEP(7);
+    }
+    GOERTZEL_STORE(0); GOERTZEL_STORE(1); GOERTZEL_STORE(2); GOERTZEL_STORE(3);
+    GOERTZEL_STORE(4); GOERTZEL_STORE(5); GOERTZEL_STORE(6); GOERTZEL_STORE(7);
+} /* goertzel32_sse2 */
+#endif
+
+goertzelBank::goertzelBank(const std::vector<float>& _freqs, double sampleRate, int _nfft,
+                           windowType type) :
+    nfft(_nfft), freqs(_freqs), coef((_freqs.size() + 15) / 16 * 16, 0),
+    window(_nfft, type), windowed(_nfft), x(_nfft), s1(coef.size()), s2(coef.size())
+{
+    for (size_t k = 0; k < freqs.size(); k++)
+        coef[k] = (float)(2 * cos(2 * M_PI * freqs[k] / sampleRate));
+} /* goertzelBank::goertzelBank */
+
+void
+goertzelBank::process(const kiss_fft_scalar* frame, float* levels)
+{
+    const int nk = size();
+    const int lanes = (int)coef.size();
+    const float* __restrict c = &coef[0];
+    float* __restrict a = &s1[0];
+    float* __restrict b = &s2[0];
+    int k = 0;
+
+    window.apply(&windowed[0], frame);
+    for (int n = 0; n < nfft; n++)
+#ifdef FIXED_POINT
+        // same full scale as the float samples
+        x[n] = windowed[n] * (1.0f / 32768);
+#else
+        x[n] = windowed[n];
+#endif
+
+#if defined(__SSE2__)
+    // The lanes are padded to a multiple of 16 with zero coefficients
+    for (; k + 32 <= lanes; k += 32)
+        goertzel32_sse2(&x[0], nfft, c + k, a + k, b + k);
+    if (k < lanes)
+        goertzel16_sse2(&x[0], nfft, c + k, a + k, b + k);
+#else
+    for (; k < nk; k++) {
+        float p = 0, q = 0;
+        for (int n = 0; n < nfft; n++) {
+            float t = x[n] + c[k] * p - q;
+            q = p;
+            p = t;
+        }
+        a[k] = p;
+        b[k] = q;
+    }
+#endif
+
+    for (k = 0; k < nk; k++) {
+        float power = a[k] * a[k] + b[k] * b[k] - c[k] * a[k] * b[k];
+        levels[k] = 10 * log10f(power > 1e-30f ? power : 1e-30f);
+    }
+} /* goertzelBank::process */
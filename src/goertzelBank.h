@@ -0,0 +1,57 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: goertzelBank.h
+ Description:
+ Goertzel filter bank, the spectrum level at a short list of arbitrary
+ frequencies without a full FFT.
+ */
+
+#ifndef GOERTZELBANK_H
+#define GOERTZELBANK_H
+
+#include <vector>
+
+// kissFFT addon include file
+#include "kiss_fft.h"
+#include "windowContext.h"
+
+class goertzelBank
+{
+public:
+    // freqs in Hz, evaluated over windowed frames of nfft samples
+    goertzelBank(const std::vector<float>& freqs, double sampleRate, int nfft,
+                 windowType type = WINDOW_KAISER);
+
+    int size() const { return (int)freqs.size(); }
+    const std::vector<float>& frequencies() const { return freqs; }
+
+    // Window nfft samples of frame and write 10log10 of the power at each
+    // frequency to levels, on the dB scale of the float FFT spectrum.
+    void process(const kiss_fft_scalar* frame, float* levels);
+
+private:
+    int nfft;
+    std::vector<float> freqs;
+    std::vector<float> coef;    // 2cos(w) per frequency, zero padded to 16 lanes
+    windowContext<kiss_fft_scalar> window;
+    std::vector<kiss_fft_scalar> windowed;
+    std::vector<float> x;       // windowed frame at float full scale
+    std::vector<float> s1, s2;  // filter states, one lane per frequency
+};
+
+#endif
@@ -22,14 +22,19 @@ static void kf_bfly2(
         kiss_fft_cpx * Fout,
         const size_t fstride,
         const kiss_fft_cfg st,
-        int m
+        size_t m,
+        size_t kbeg,
+        size_t kend
         )
 {
+    /* butterflies kbeg..kend-1 of a stage with m of them */
     kiss_fft_cpx * Fout2;
-    kiss_fft_cpx * tw1 = st->twiddles;
+    kiss_fft_cpx * tw1 = st->twiddles + kbeg*fstride;
     kiss_fft_cpx t;
+    size_t k;
+    Fout += kbeg;
     Fout2 = Fout + m;
-    do{
+    for (k=kbeg;k<kend;++k) {
         C_FIXDIV(*Fout,2); C_FIXDIV(*Fout2,2);
 
         C_MUL (t,  *Fout2 , *tw1);
@@ -38,26 +43,30 @@ static void kf_bfly2(
         C_ADDTO( *Fout ,  t );
         ++Fout2;
         ++Fout;
-    }while (--m);
+    }
 }
 
 static void kf_bfly4(
         kiss_fft_cpx * Fout,
         const size_t fstride,
         const kiss_fft_cfg st,
-        const size_t m
+        const size_t m,
+        size_t kbeg,
+        size_t kend
         )
 {
     kiss_fft_cpx *tw1,*tw2,*tw3;
     kiss_fft_cpx scratch[6];
-    size_t k=m;
+    size_t k;
     const size_t m2=2*m;
     const size_t m3=3*m;
 
+    tw1 = st->twiddles + kbeg*fstride;
+    tw2 = st->twiddles + kbeg*fstride*2;
+    tw3 = st->twiddles + kbeg*fstride*3;
+    Fout += kbeg;
 
-    tw3 = tw2 = tw1 = st->twiddles;
-
-    do {
+    for (k=kbeg;k<kend;++k) {
         C_FIXDIV(*Fout,4); C_FIXDIV(Fout[m],4); C_FIXDIV(Fout[m2],4); C_FIXDIV(Fout[m3],4);
 
         C_MUL(scratch[0],Fout[m] , *tw1 );
@@ -86,7 +95,80 @@ static void kf_bfly4(
             Fout[m3].i = scratch[5].i + scratch[4].r;
         }
         ++Fout;
-    }while(--k);
+    }
+}
+
+/* -i*z for a forward transform, +i*z for an inverse one */
+static inline kiss_fft_cpx kf_rot(kiss_fft_cpx z, int inverse)
+{
+    kiss_fft_cpx t;
+    if (inverse) {
+        t.r = -z.i; t.i = z.r;
+    }else{
+        t.r = z.i;  t.i = -z.r;
+    }
+    return t;
+}
+
+/*
+ * Radix-8 butterfly: the 8 point DFT is split into two radix-4 DFTs of the
+ * even and odd inputs, recombined with W8^1..3. W8 and W8^3 are
+ * (1 -+ i)/sqrt(2) and (-1 -+ i)/sqrt(2), so they cost one rotation and one
+ * real scaling each instead of a complex multiply. Power of two sizes need
+ * a third fewer passes than with radix 4 and 2.
+ */
+static void kf_bfly8(
+        kiss_fft_cpx * Fout,
+        const size_t fstride,
+        const kiss_fft_cfg st,
+        const size_t m,
+        size_t kbeg,
+        size_t kend
+        )
+{
+    const int inv = st->inverse;
+    /* cos(pi/4), taken from the table so fixed point gets it in its format */
+    const kiss_fft_scalar c = st->twiddles[fstride*m].r;
+    kiss_fft_cpx x[8], t0, t1, t2, t3, e[4], o[4];
+    size_t k;
+    int q;
+
+    for (k=kbeg;k<kend;++k) {
+        kiss_fft_cpx * F = Fout + k;
+        for (q=0;q<8;++q)
+            C_FIXDIV(F[q*m],8);
+        x[0] = F[0];
+        for (q=1;q<8;++q)
+            C_MUL(x[q], F[q*m], st->twiddles[q*k*fstride]);
+
+        /* even inputs */
+        C_ADD(t0, x[0], x[4]);  C_SUB(t1, x[0], x[4]);
+        C_ADD(t2, x[2], x[6]);  C_SUB(t3, x[2], x[6]);
+        t3 = kf_rot(t3, inv);
+        C_ADD(e[0], t0, t2);    C_SUB(e[2], t0, t2);
+        C_ADD(e[1], t1, t3);    C_SUB(e[3], t1, t3);
+
+        /* odd inputs */
+        C_ADD(t0, x[1], x[5]);  C_SUB(t1, x[1], x[5]);
+        C_ADD(t2, x[3], x[7]);  C_SUB(t3, x[3], x[7]);
+        t3 = kf_rot(t3, inv);
+        C_ADD(o[0], t0, t2);    C_SUB(o[2], t0, t2);
+        C_ADD(o[1], t1, t3);    C_SUB(o[3], t1, t3);
+
+        /* o[q] *= W8^q */
+        t0 = kf_rot(o[1], inv);
+        C_ADDTO(o[1], t0);
+        C_MULBYSCALAR(o[1], c);
+        o[2] = kf_rot(o[2], inv);
+        t0 = kf_rot(o[3], inv);
+        C_SUB(o[3], t0, o[3]);
+        C_MULBYSCALAR(o[3], c);
+
+        for (q=0;q<4;++q) {
+            C_ADD(F[q*m], e[q], o[q]);
+            C_SUB(F[(q+4)*m], e[q], o[q]);
+        }
+    }
 }
 
 static void kf_bfly3(
@@ -234,6 +316,276 @@ static void kf_bfly_generic(
     KISS_FFT_TMP_FREE(scratch);
 }
 
+#ifdef KISS_FFT_X86_SIMD
+/*
+ * SSE2 / AVX2 versions of the radix-2 and radix-4 butterflies.
+ *
+ * They vectorize across the m butterflies of a stage, 2 (SSE2) or 4 (AVX2)
+ * complex values per register in the same interleaved r,i layout as
+ * kiss_fft_cpx, so no repacking is needed. In st->twiddles the twiddles of
+ * consecutive butterflies sit fstride apart, so each stage gets its own
+ * contiguous copy (see kf_stage_twiddles): tw[(q-1)*m + k] = W^(q*k*fstride).
+ * Left over butterflies (m not a multiple of the width) go to the scalar code.
+ */
+
+#define KF_SSE2 __attribute__((target("sse2")))
+
+static inline KF_SSE2 __m128 kf_sse2_cmul(__m128 a, __m128 b)
+{
+    const __m128 neg_re = _mm_castsi128_ps(_mm_set_epi32(0, (int)0x80000000, 0, (int)0x80000000));
+    __m128 br = _mm_shuffle_ps(b, b, _MM_SHUFFLE(2,2,0,0));
+    __m128 bi = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3,3,1,1));
+    __m128 as = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2,3,0,1));
+    return _mm_add_ps(_mm_mul_ps(a, br), _mm_xor_ps(_mm_mul_ps(as, bi), neg_re));
+}
+
+static KF_SSE2 void kf_bfly2_sse2(kiss_fft_cpx * Fout, const size_t fstride, const kiss_fft_cfg st,
+        const kiss_fft_cpx * tw, size_t m, size_t kbeg, size_t kend)
+{
+    size_t k;
+    for (k=kbeg; k+2<=kend; k+=2) {
+        __m128 a = _mm_loadu_ps((float*)(Fout+k));
+        __m128 b = _mm_loadu_ps((float*)(Fout+k+m));
+        __m128 t = kf_sse2_cmul(b, _mm_loadu_ps((const float*)(tw+k)));
+        _mm_storeu_ps((float*)(Fout+k+m), _mm_sub_ps(a, t));
+        _mm_storeu_ps((float*)(Fout+k), _mm_add_ps(a, t));
+    }
+    if (k<kend)
+        kf_bfly2(Fout,fstride,st,m,k,kend);
+}
+
+static KF_SSE2 void kf_bfly4_sse2(kiss_fft_cpx * Fout, const size_t fstride, const kiss_fft_cfg st,
+        const kiss_fft_cpx * tw, size_t m, size_t kbeg, size_t kend)
+{
+    /* multiplying by -i (forward) or +i (inverse) is a swap plus a sign flip */
+    const __m128 rot_sign = st->inverse
+        ? _mm_castsi128_ps(_mm_set_epi32(0, (int)0x80000000, 0, (int)0x80000000))
+        : _mm_castsi128_ps(_mm_set_epi32((int)0x80000000, 0, (int)0x80000000, 0));
+    size_t k;
+    for (k=kbeg; k+2<=kend; k+=2) {
+        __m128 f0 = _mm_loadu_ps((float*)(Fout+k));
+        __m128 f1 = _mm_loadu_ps((float*)(Fout+k+m));
+        __m128 f2 = _mm_loadu_ps((float*)(Fout+k+2*m));
+        __m128 f3 = _mm_loadu_ps((float*)(Fout+k+3*m));
+        __m128 s0 = kf_sse2_cmul(f1, _mm_loadu_ps((const float*)(tw+k)));
+        __m128 s1 = kf_sse2_cmul(f2, _mm_loadu_ps((const float*)(tw+m+k)));
+        __m128 s2 = kf_sse2_cmul(f3, _mm_loadu_ps((const float*)(tw+2*m+k)));
+        __m128 s5 = _mm_sub_ps(f0, s1);
+        __m128 s3, s4;
+        f0 = _mm_add_ps(f0, s1);
+        s3 = _mm_add_ps(s0, s2);
+        s4 = _mm_sub_ps(s0, s2);
+        s4 = _mm_xor_ps(_mm_shuffle_ps(s4, s4, _MM_SHUFFLE(2,3,0,1)), rot_sign);
+        _mm_storeu_ps((float*)(Fout+k+2*m), _mm_sub_ps(f0, s3));
+        _mm_storeu_ps((float*)(Fout+k), _mm_add_ps(f0, s3));
+        _mm_storeu_ps((float*)(Fout+k+m), _mm_add_ps(s5, s4));
+        _mm_storeu_ps((float*)(Fout+k+3*m), _mm_sub_ps(s5, s4));
+    }
+    if (k<kend)
+        kf_bfly4(Fout,fstride,st,m,k,kend);
+}
+
+static KF_SSE2 void kf_bfly8_sse2(kiss_fft_cpx * Fout, const size_t fstride, const kiss_fft_cfg st,
+        const kiss_fft_cpx * tw, size_t m, size_t kbeg, size_t kend)
+{
+    const __m128 rot_sign = st->inverse
+        ? _mm_castsi128_ps(_mm_set_epi32(0, (int)0x80000000, 0, (int)0x80000000))
+        : _mm_castsi128_ps(_mm_set_epi32((int)0x80000000, 0, (int)0x80000000, 0));
+    const __m128 c = _mm_set1_ps(0.70710678118654752f);
+#define KF_ROT_SSE2(v) _mm_xor_ps(_mm_shuffle_ps(v, v, _MM_SHUFFLE(2,3,0,1)), rot_sign)
+    size_t k;
+    int q;
+    for (k=kbeg; k+2<=kend; k+=2) {
+        __m128 x[8], t0, t1, t2, t3, e0, e1, e2, e3, o0, o1, o2, o3;
+        x[0] = _mm_loadu_ps((float*)(Fout+k));
+        for (q=1;q<8;++q)
+            x[q] = kf_sse2_cmul(_mm_loadu_ps((float*)(Fout+k+q*m)),
+                                _mm_loadu_ps((const float*)(tw+(q-1)*m+k)));
+
+        t0 = _mm_add_ps(x[0], x[4]);  t1 = _mm_sub_ps(x[0], x[4]);
+        t2 = _mm_add_ps(x[2], x[6]);  t3 = _mm_sub_ps(x[2], x[6]);
+        t3 = KF_ROT_SSE2(t3);
+        e0 = _mm_add_ps(t0, t2);      e2 = _mm_sub_ps(t0, t2);
+        e1 = _mm_add_ps(t1, t3);      e3 = _mm_sub_ps(t1, t3);
+
+        t0 = _mm_add_ps(x[1], x[5]);  t1 = _mm_sub_ps(x[1], x[5]);
+        t2 = _mm_add_ps(x[3], x[7]);  t3 = _mm_sub_ps(x[3], x[7]);
+        t3 = KF_ROT_SSE2(t3);
+        o0 = _mm_add_ps(t0, t2);      o2 = _mm_sub_ps(t0, t2);
+        o1 = _mm_add_ps(t1, t3);      o3 = _mm_sub_ps(t1, t3);
+
+        o1 = _mm_mul_ps(_mm_add_ps(o1, KF_ROT_SSE2(o1)), c);
+        o2 = KF_ROT_SSE2(o2);
+        o3 = _mm_mul_ps(_mm_sub_ps(KF_ROT_SSE2(o3), o3), c);
+
+        _mm_storeu_ps((float*)(Fout+k),       _mm_add_ps(e0, o0));
+        _mm_storeu_ps((float*)(Fout+k+4*m),   _mm_sub_ps(e0, o0));
+        _mm_storeu_ps((float*)(Fout+k+m),     _mm_add_ps(e1, o1));
+        _mm_storeu_ps((float*)(Fout+k+5*m),   _mm_sub_ps(e1, o1));
+        _mm_storeu_ps((float*)(Fout+k+2*m),   _mm_add_ps(e2, o2));
+        _mm_storeu_ps((float*)(Fout+k+6*m),   _mm_sub_ps(e2, o2));
+        _mm_storeu_ps((float*)(Fout+k+3*m),   _mm_add_ps(e3, o3));
+        _mm_storeu_ps((float*)(Fout+k+7*m),   _mm_sub_ps(e3, o3));
+    }
+#undef KF_ROT_SSE2
+    if (k<kend)
+        kf_bfly8(Fout,fstride,st,m,k,kend);
+}
+
+#define KF_AVX2 __attribute__((target("avx2")))
+
+static inline KF_AVX2 __m256 kf_avx2_cmul(__m256 a, __m256 b)
+{
+    __m256 br = _mm256_moveldup_ps(b);
+    __m256 bi = _mm256_movehdup_ps(b);
+    __m256 as = _mm256_permute_ps(a, _MM_SHUFFLE(2,3,0,1));
+    return _mm256_addsub_ps(_mm256_mul_ps(a, br), _mm256_mul_ps(as, bi));
+}
+
+static KF_AVX2 void kf_bfly2_avx2(kiss_fft_cpx * Fout, const size_t fstride, const kiss_fft_cfg st,
+        const kiss_fft_cpx * tw, size_t m, size_t kbeg, size_t kend)
+{
+    size_t k;
+    for (k=kbeg; k+4<=kend; k+=4) {
+        __m256 a = _mm256_loadu_ps((float*)(Fout+k));
+        __m256 b = _mm256_loadu_ps((float*)(Fout+k+m));
+        __m256 t = kf_avx2_cmul(b, _mm256_loadu_ps((const float*)(tw+k)));
+        _mm256_storeu_ps((float*)(Fout+k+m), _mm256_sub_ps(a, t));
+        _mm256_storeu_ps((float*)(Fout+k), _mm256_add_ps(a, t));
+    }
+    /* the scalar tail is legacy SSE code, leave the upper ymm halves clean */
+    _mm256_zeroupper();
+    if (k<kend)
+        kf_bfly2(Fout,fstride,st,m,k,kend);
+}
+
+static KF_AVX2 void kf_bfly4_avx2(kiss_fft_cpx * Fout, const size_t fstride, const kiss_fft_cfg st,
+        const kiss_fft_cpx * tw, size_t m, size_t kbeg, size_t kend)
+{
+    const __m256 rot_sign = st->inverse
+        ? _mm256_castsi256_ps(_mm256_set1_epi64x((long long)0x0000000080000000LL))
+        : _mm256_castsi256_ps(_mm256_set1_epi64x((long long)0x8000000000000000ULL));
+    size_t k;
+    for (k=kbeg; k+4<=kend; k+=4) {
+        __m256 f0 = _mm256_loadu_ps((float*)(Fout+k));
+        __m256 f1 = _mm256_loadu_ps((float*)(Fout+k+m));
+        __m256 f2 = _mm256_loadu_ps((float*)(Fout+k+2*m));
+        __m256 f3 = _mm256_loadu_ps((float*)(Fout+k+3*m));
+        __m256 s0 = kf_avx2_cmul(f1, _mm256_loadu_ps((const float*)(tw+k)));
+        __m256 s1 = kf_avx2_cmul(f2, _mm256_loadu_ps((const float*)(tw+m+k)));
+        __m256 s2 = kf_avx2_cmul(f3, _mm256_loadu_ps((const float*)(tw+2*m+k)));
+        __m256 s5 = _mm256_sub_ps(f0, s1);
+        __m256 s3, s4;
+        f0 = _mm256_add_ps(f0, s1);
+        s3 = _mm256_add_ps(s0, s2);
+        s4 = _mm256_sub_ps(s0, s2);
+        s4 = _mm256_xor_ps(_mm256_permute_ps(s4, _MM_SHUFFLE(2,3,0,1)), rot_sign);
+        _mm256_storeu_ps((float*)(Fout+k+2*m), _mm256_sub_ps(f0, s3));
+        _mm256_storeu_ps((float*)(Fout+k), _mm256_add_ps(f0, s3));
+        _mm256_storeu_ps((float*)(Fout+k+m), _mm256_add_ps(s5, s4));
+        _mm256_storeu_ps((float*)(Fout+k+3*m), _mm256_sub_ps(s5, s4));
+    }
+    _mm256_zeroupper();
+    if (k<kend)
+        kf_bfly4(Fout,fstride,st,m,k,kend);
+}
+
+static KF_AVX2 void kf_bfly8_avx2(kiss_fft_cpx * Fout, const size_t fstride, const kiss_fft_cfg st,
+        const kiss_fft_cpx * tw, size_t m, size_t kbeg, size_t kend)
+{
+    const __m256 rot_sign = st->inverse
+        ? _mm256_castsi256_ps(_mm256_set1_epi64x((long long)0x0000000080000000LL))
+        : _mm256_castsi256_ps(_mm256_set1_epi64x((long long)0x8000000000000000ULL));
+    const __m256 c = _mm256_set1_ps(0.70710678118654752f);
+#define KF_ROT_AVX2(v) _mm256_xor_ps(_mm256_permute_ps(v, _MM_SHUFFLE(2,3,0,1)), rot_sign)
+    size_t k;
+    int q;
+    for (k=kbeg; k+4<=kend; k+=4) {
+        __m256 x[8], t0, t1, t2, t3, e0, e1, e2, e3, o0, o1, o2, o3;
+        x[0] = _mm256_loadu_ps((float*)(Fout+k));
+        for (q=1;q<8;++q)
+            x[q] = kf_avx2_cmul(_mm256_loadu_ps((float*)(Fout+k+q*m)),
+                                _mm256_loadu_ps((const float*)(tw+(q-1)*m+k)));
+
+        t0 = _mm256_add_ps(x[0], x[4]);  t1 = _mm256_sub_ps(x[0], x[4]);
+        t2 = _mm256_add_ps(x[2], x[6]);  t3 = _mm256_sub_ps(x[2], x[6]);
+        t3 = KF_ROT_AVX2(t3);
+        e0 = _mm256_add_ps(t0, t2);      e2 = _mm256_sub_ps(t0, t2);
+        e1 = _mm256_add_ps(t1, t3);      e3 = _mm256_sub_ps(t1, t3);
+
+        t0 = _mm256_add_ps(x[1], x[5]);  t1 = _mm256_sub_ps(x[1], x[5]);
+        t2 = _mm256_add_ps(x[3], x[7]);  t3 = _mm256_sub_ps(x[3], x[7]);
+        t3 = KF_ROT_AVX2(t3);
+        o0 = _mm256_add_ps(t0, t2);      o2 = _mm256_sub_ps(t0, t2);
+        o1 = _mm256_add_ps(t1, t3);      o3 = _mm256_sub_ps(t1, t3);
+
+        o1 = _mm256_mul_ps(_mm256_add_ps(o1, KF_ROT_AVX2(o1)), c);
+        o2 = KF_ROT_AVX2(o2);
+        o3 = _mm256_mul_ps(_mm256_sub_ps(KF_ROT_AVX2(o3), o3), c);
+
+        _mm256_storeu_ps((float*)(Fout+k),       _mm256_add_ps(e0, o0));
+        _mm256_storeu_ps((float*)(Fout+k+4*m),   _mm256_sub_ps(e0, o0));
+        _mm256_storeu_ps((float*)(Fout+k+m),     _mm256_add_ps(e1, o1));
+        _mm256_storeu_ps((float*)(Fout+k+5*m),   _mm256_sub_ps(e1, o1));
+        _mm256_storeu_ps((float*)(Fout+k+2*m),   _mm256_add_ps(e2, o2));
+        _mm256_storeu_ps((float*)(Fout+k+6*m),   _mm256_sub_ps(e2, o2));
+        _mm256_storeu_ps((float*)(Fout+k+3*m),   _mm256_add_ps(e3, o3));
+        _mm256_storeu_ps((float*)(Fout+k+7*m),   _mm256_sub_ps(e3, o3));
+    }
+#undef KF_ROT_AVX2
+    _mm256_zeroupper();
+    if (k<kend)
+        kf_bfly8(Fout,fstride,st,m,k,kend);
+}
+#endif /* KISS_FFT_X86_SIMD */
+
+/*
+ * recombine the p smaller DFTs of one stage, using the kernels picked at alloc time.
+ * Only butterflies kbeg..kend-1 are done; radix 3, 5 and generic stages always
+ * do all m of them.
+ */
+static void kf_bfly(
+        kiss_fft_cpx * Fout,
+        const size_t fstride,
+        const kiss_fft_cfg st,
+        int stage,
+        int m,
+        int p,
+        int kbeg,
+        int kend
+        )
+{
+#ifdef KISS_FFT_X86_SIMD
+    if (st->stage_twiddles[stage] >= 0) {
+        const kiss_fft_cpx * tw = st->twiddles + st->nfft + st->stage_twiddles[stage];
+        /* stages too short for a full ymm register are left to SSE2 */
+        if (st->simd == KISS_FFT_SIMD_AVX2 && kend-kbeg >= 4) {
+            switch (p) {
+                case 2: kf_bfly2_avx2(Fout,fstride,st,tw,m,kbeg,kend); return;
+                case 4: kf_bfly4_avx2(Fout,fstride,st,tw,m,kbeg,kend); return;
+                case 8: kf_bfly8_avx2(Fout,fstride,st,tw,m,kbeg,kend); return;
+            }
+        } else {
+            switch (p) {
+                case 2: kf_bfly2_sse2(Fout,fstride,st,tw,m,kbeg,kend); return;
+                case 4: kf_bfly4_sse2(Fout,fstride,st,tw,m,kbeg,kend); return;
+                case 8: kf_bfly8_sse2(Fout,fstride,st,tw,m,kbeg,kend); return;
+            }
+        }
+    }
+#else
+    (void)stage;
+#endif
+    switch (p) {
+        case 2: kf_bfly2(Fout,fstride,st,m,kbeg,kend); break;
+        case 3: kf_bfly3(Fout,fstride,st,m); break;
+        case 4: kf_bfly4(Fout,fstride,st,m,kbeg,kend); break;
+        case 5: kf_bfly5(Fout,fstride,st,m); break;
+        case 8: kf_bfly8(Fout,fstride,st,m,kbeg,kend); break;
+        default: kf_bfly_generic(Fout,fstride,st,m,p); break;
+    }
+}
+
 static
 void kf_work(
         kiss_fft_cpx * Fout,
@@ -245,6 +597,7 @@ void kf_work(
         )
 {
     kiss_fft_cpx * Fout_beg=Fout;
+    const int stage=(int)(factors - st->factors)/2;
     const int p=*factors++; /* the radix  */
     const int m=*factors++; /* stage's fft length/p */
     const kiss_fft_cpx * Fout_end = Fout + p*m;
@@ -252,7 +605,7 @@ void kf_work(
 #ifdef _OPENMP
     // use openmp extensions at the 
     // top-level (not recursive)
-    if (fstride==1 && p<=5)
+    if (fstride==1 && (p<=5 || p==8))
     {
         int k;
 
@@ -262,13 +615,7 @@ void kf_work(
             kf_work( Fout +k*m, f+ fstride*in_stride*k,fstride*p,in_stride,factors,st);
         // all threads have joined by this point
 
-        switch (p) {
-            case 2: kf_bfly2(Fout,fstride,st,m); break;
-            case 3: kf_bfly3(Fout,fstride,st,m); break; 
-            case 4: kf_bfly4(Fout,fstride,st,m); break;
-            case 5: kf_bfly5(Fout,fstride,st,m); break; 
-            default: kf_bfly_generic(Fout,fstride,st,m,p); break;
-        }
+        kf_bfly(Fout,fstride,st,stage,m,p,0,m);
         return;
     }
 #endif
@@ -292,13 +639,62 @@ void kf_work(
     Fout=Fout_beg;
 
     // recombine the p smaller DFTs 
-    switch (p) {
-        case 2: kf_bfly2(Fout,fstride,st,m); break;
-        case 3: kf_bfly3(Fout,fstride,st,m); break; 
-        case 4: kf_bfly4(Fout,fstride,st,m); break;
-        case 5: kf_bfly5(Fout,fstride,st,m); break; 
-        default: kf_bfly_generic(Fout,fstride,st,m,p); break;
+    kf_bfly(Fout,fstride,st,stage,m,p,0,m);
+}
+
+/*
+ * Output pruning. Only the bins k < band and k > n-band of this (sub)
+ * transform of n = p*m points are wanted. Butterfly k of a stage writes
+ * bins k + q*m, so it is needed when k lies in the same cyclic band modulo
+ * m, and it reads bin k of each of the p sub-transforms; those therefore
+ * need the same band again. Once the band covers a whole (sub)transform
+ * the ordinary kf_work takes over.
+ */
+static
+void kf_bfly_pruned(
+        kiss_fft_cpx * Fout,
+        const size_t fstride,
+        const kiss_fft_cfg st,
+        int stage,
+        int m,
+        int p,
+        int band
+        )
+{
+    if (2*band-1 >= m || (p!=2 && p!=4 && p!=8)) {
+        /* every butterfly is needed, or no ranged kernel for this radix */
+        kf_bfly(Fout,fstride,st,stage,m,p,0,m);
+        return;
     }
+    kf_bfly(Fout,fstride,st,stage,m,p,0,band);
+    kf_bfly(Fout,fstride,st,stage,m,p,m-band+1,m);
+}
+
+static
+void kf_work_pruned(
+        kiss_fft_cpx * Fout,
+        const kiss_fft_cpx * f,
+        const size_t fstride,
+        int in_stride,
+        int * factors,
+        const kiss_fft_cfg st,
+        int band
+        )
+{
+    const int stage=(int)(factors - st->factors)/2;
+    const int p=factors[0];
+    const int m=factors[1];
+    int q;
+
+    if (m==1 || 2*band-1 >= p*m) {
+        kf_work(Fout,f,fstride,in_stride,factors,st);
+        return;
+    }
+
+    for (q=0;q<p;++q)
+        kf_work_pruned(Fout+q*m, f+q*fstride*in_stride, fstride*p, in_stride, factors+2, st, band);
+
+    kf_bfly_pruned(Fout,fstride,st,stage,m,p,band);
 }
 
 /*  facbuf is populated by p1,m1,p2,m2, ...
@@ -306,16 +702,17 @@ void kf_work(
     p[i] * m[i] = m[i-1]
     m0 = n                  */
 static 
-void kf_factor(int n,int * facbuf)
+void kf_factor(int n,int * facbuf,int radix8)
 {
-    int p=4;
+    int p=radix8 ? 8 : 4;
     double floor_sqrt;
     floor_sqrt = floor( sqrt((double)n) );
 
-    /*factor out powers of 4, powers of 2, then any remaining primes */
+    /*factor out powers of 8 (unless disabled), 4, 2, then any remaining primes */
     do {
         while (n % p) {
             switch (p) {
+                case 8: p = 4; break;
                 case 4: p = 2; break;
                 case 2: p = 3; break;
                 default: p += 2; break;
@@ -329,6 +726,41 @@ void kf_factor(int n,int * facbuf)
     } while (n > 1);
 }
 
+/*
+ * Lay out the twiddles of every radix 2/4/8 stage contiguously for the SIMD
+ * butterflies and record where each stage's copy starts. Called with
+ * st==NULL it only counts how many kiss_fft_cpx that takes.
+ */
+static
+size_t kf_stage_twiddles(kiss_fft_cfg st,const int * factors,int simd)
+{
+    size_t used=0, fstride=1;
+    int stage=0;
+    do {
+        const int p=factors[2*stage], m=factors[2*stage+1];
+        int vector_stage = 0;
+#ifdef KISS_FFT_X86_SIMD
+        vector_stage = simd != KISS_FFT_SIMD_NONE && (p==2 || p==4 || p==8) && m>1;
+#else
+        (void)simd;
+#endif
+        if (st)
+            st->stage_twiddles[stage] = vector_stage ? (int)used : -1;
+        if (vector_stage) {
+            if (st) {
+                kiss_fft_cpx * tw = st->twiddles + st->nfft + used;
+                int q, k;
+                for (q=1;q<p;++q)
+                    for (k=0;k<m;++k)
+                        *tw++ = st->twiddles[q*k*fstride];
+            }
+            used += (size_t)(p-1)*m;
+        }
+        fstride *= p;
+    } while (factors[2*stage++ +1] > 1);
+    return used;
+}
+
 /*
  *
  * User-callable function to allocate all necessary storage space for the fft.
@@ -337,10 +769,25 @@ void kf_factor(int n,int * facbuf)
  * It can be freed with free(), rather than a kiss_fft-specific function.
  * */
 kiss_fft_cfg kiss_fft_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem )
+{
+    return kiss_fft_alloc_flags(nfft,inverse_fft,KISS_FFT_SIMD_AUTO,mem,lenmem);
+}
+
+kiss_fft_cfg kiss_fft_alloc_flags(int nfft,int inverse_fft,int flags,void * mem,size_t * lenmem )
 {
     kiss_fft_cfg st=NULL;
-    size_t memneeded = sizeof(struct kiss_fft_state)
-        + sizeof(kiss_fft_cpx)*(nfft-1); /* twiddle factors*/
+    int factors[2*MAXFACTORS];
+    int simd = flags & KISS_FFT_SIMD_MASK;
+    int best = kiss_fft_simd_detect();
+    size_t memneeded;
+
+    if (simd == KISS_FFT_SIMD_AUTO || simd > best)
+        simd = best;
+    kf_factor(nfft,factors,!(flags & KISS_FFT_NO_RADIX8));
+
+    memneeded = sizeof(struct kiss_fft_state)
+        + sizeof(kiss_fft_cpx)*(nfft-1) /* twiddle factors*/
+        + sizeof(kiss_fft_cpx)*kf_stage_twiddles(NULL,factors,simd); /* per stage SIMD copies */
 
     if ( lenmem==NULL ) {
         st = ( kiss_fft_cfg)KISS_FFT_MALLOC( memneeded );
@@ -353,6 +800,7 @@ kiss_fft_cfg kiss_fft_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem
         int i;
         st->nfft=nfft;
         st->inverse = inverse_fft;
+        st->simd = simd;
 
         for (i=0;i<nfft;++i) {
             const double pi=3.141592653589793238462643383279502884197169399375105820974944;
@@ -362,7 +810,8 @@ kiss_fft_cfg kiss_fft_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem
             kf_cexp(st->twiddles+i, phase );
         }
 
-        kf_factor(nfft,st->factors);
+        memcpy(st->factors,factors,sizeof(factors));
+        kf_stage_twiddles(st,factors,simd);
     }
     return st;
 }
@@ -382,12 +831,53 @@ void kiss_fft_stride(kiss_fft_cfg st,const kiss_fft_cpx *fin,kiss_fft_cpx *fout,
     }
 }
 
+void kiss_fft_pruned(kiss_fft_cfg st,const kiss_fft_cpx *fin,kiss_fft_cpx *fout,int band)
+{
+    if (band < 1)
+        band = 1;
+    if (fin == fout) {
+        kiss_fft_cpx * tmpbuf = (kiss_fft_cpx*)KISS_FFT_TMP_ALLOC( sizeof(kiss_fft_cpx)*st->nfft);
+        kf_work_pruned(tmpbuf,fin,1,1,st->factors,st,band);
+        memcpy(fout,tmpbuf,sizeof(kiss_fft_cpx)*st->nfft);
+        KISS_FFT_TMP_FREE(tmpbuf);
+    }else{
+        kf_work_pruned(fout,fin,1,1,st->factors,st,band);
+    }
+}
+
 void kiss_fft(kiss_fft_cfg cfg,const kiss_fft_cpx *fin,kiss_fft_cpx *fout)
 {
     kiss_fft_stride(cfg,fin,fout,1);
 }
 
 
+int kiss_fft_simd_detect(void)
+{
+#ifdef KISS_FFT_X86_SIMD
+    unsigned int a,b,c,d;
+    int level = KISS_FFT_SIMD_NONE;
+
+    if (!__get_cpuid(1,&a,&b,&c,&d))
+        return level;
+    if (d & bit_SSE2)
+        level = KISS_FFT_SIMD_SSE2;
+
+    /* AVX needs the OS to save the ymm state as well (XCR0 bits 1 and 2) */
+    if ((c & bit_OSXSAVE) && (c & bit_AVX)) {
+        unsigned int xcr0_lo, xcr0_hi;
+        __asm__ __volatile__ ("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+        if ((xcr0_lo & 6) == 6 && __get_cpuid_max(0,NULL) >= 7) {
+            __cpuid_count(7,0,a,b,c,d);
+            if (b & bit_AVX2)
+                level = KISS_FFT_SIMD_AVX2;
+        }
+    }
+    return level;
+#else
+    return KISS_FFT_SIMD_NONE;
+#endif
+}
+
 void kiss_fft_cleanup(void)
 {
     // nothing needed any more
@@ -80,6 +80,41 @@ typedef struct kiss_fft_state* kiss_fft_cfg;
 
 kiss_fft_cfg kiss_fft_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem); 
 
+/*
+ * Allocation flags.
+ *
+ * The low bits select the butterfly kernels used by the float build.
+ * KISS_FFT_SIMD_AUTO (what kiss_fft_alloc uses) picks the widest set the
+ * running cpu supports, as reported by kiss_fft_simd_detect(). Asking for
+ * a wider set than the cpu has is clamped down, so forcing a level is
+ * always safe. Fixed point and USE_SIMD builds always run the scalar code.
+ */
+#define KISS_FFT_SIMD_MASK  0x0f
+#define KISS_FFT_SIMD_AUTO  0x00
+#define KISS_FFT_SIMD_NONE  0x01
+#define KISS_FFT_SIMD_SSE2  0x02
+#define KISS_FFT_SIMD_AVX2  0x03
+
+/*
+ * Factor sizes into 4s and 2s only. By default powers of 8 are taken out
+ * first and run through the radix-8 butterfly, which needs fewer passes
+ * over the data; this restores the original factorization.
+ */
+#define KISS_FFT_NO_RADIX8  0x10
+
+/*
+ * kiss_fft_alloc_flags
+ *
+ * Same as kiss_fft_alloc, with the kernel selection given by flags.
+ * */
+kiss_fft_cfg kiss_fft_alloc_flags(int nfft,int inverse_fft,int flags,void * mem,size_t * lenmem);
+
+/*
+ * Returns the widest KISS_FFT_SIMD_* level usable on this cpu (cpuid plus
+ * the OS support check for the AVX register state).
+ */
+int kiss_fft_simd_detect(void);
+
 /*
  * kiss_fft(cfg,in_out_buf)
  *
@@ -97,6 +132,16 @@ void kiss_fft(kiss_fft_cfg cfg,const kiss_fft_cpx *fin,kiss_fft_cpx *fout);
  * */
 void kiss_fft_stride(kiss_fft_cfg cfg,const kiss_fft_cpx *fin,kiss_fft_cpx *fout,int fin_stride);
 
+/*
+ * kiss_fft_pruned
+ *
+ * Like kiss_fft, but only fout[k] for k < band and k > nfft-band are
+ * computed; the other outputs are left undefined. Butterflies that only
+ * feed unwanted bins are skipped, which pays off once 2*band is small
+ * compared to the transform (or its outer stages).
+ * */
+void kiss_fft_pruned(kiss_fft_cfg cfg,const kiss_fft_cpx *fin,kiss_fft_cpx *fout,int band);
+
 /* If kiss_fft_alloc allocated a buffer, it is one contiguous 
    buffer and can be simply free()d when no longer needed*/
 #define kiss_fft_free free
@@ -15,20 +15,37 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 #include "kiss_fftr.h"
 #include "_kiss_fft_guts.h"
 
+/* The state is never written after kiss_fftr_alloc, so one cfg can be
+   shared by several threads. The _scratch transforms work in memory the
+   caller owns, the plain ones allocate it with KISS_FFT_TMP_ALLOC. */
 struct kiss_fftr_state{
     kiss_fft_cfg substate;
-    kiss_fft_cpx * tmpbuf;
     kiss_fft_cpx * super_twiddles;
 #ifdef USE_SIMD
     void * pad;
 #endif
 };
 
+/* scratch of the plain entry points, an out of memory is fatal there */
+#define KF_SCRATCH_ALLOC(ptr,nbytes) \
+    do { \
+        (ptr) = KISS_FFT_TMP_ALLOC(nbytes); \
+        if ((ptr) == NULL) { \
+            fprintf(stderr,"kiss fft: out of memory for scratch\n"); \
+            exit(1); \
+        } \
+    } while (0)
+
 kiss_fftr_cfg kiss_fftr_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem)
+{
+    return kiss_fftr_alloc_flags(nfft,inverse_fft,KISS_FFT_SIMD_AUTO,mem,lenmem);
+}
+
+kiss_fftr_cfg kiss_fftr_alloc_flags(int nfft,int inverse_fft,int flags,void * mem,size_t * lenmem)
 {
     int i;
     kiss_fftr_cfg st = NULL;
-    size_t subsize, memneeded;
+    size_t subsize, twsize, memneeded;
 
     if (nfft & 1) {
         fprintf(stderr,"Real FFT optimization must be even.\n");
@@ -36,8 +53,11 @@ kiss_fftr_cfg kiss_fftr_alloc(int nfft,int inverse_fft,void * mem,size_t * lenme
     }
     nfft >>= 1;
 
-    kiss_fft_alloc (nfft, inverse_fft, NULL, &subsize);
-    memneeded = sizeof(struct kiss_fftr_state) + subsize + sizeof(kiss_fft_cpx) * ( nfft * 3 / 2);
+    kiss_fft_alloc_flags (nfft, inverse_fft, flags, NULL, &subsize);
+    /* keep each part 16 byte aligned for the SIMD kernels */
+    subsize = (subsize + 15) & ~(size_t)15;
+    twsize = (sizeof(kiss_fft_cpx) * ( nfft / 2) + 15) & ~(size_t)15;
+    memneeded = sizeof(struct kiss_fftr_state) + subsize + twsize;
 
     if (lenmem == NULL) {
         st = (kiss_fftr_cfg) KISS_FFT_MALLOC (memneeded);
@@ -50,9 +70,8 @@ kiss_fftr_cfg kiss_fftr_alloc(int nfft,int inverse_fft,void * mem,size_t * lenme
         return NULL;
 
     st->substate = (kiss_fft_cfg) (st + 1); /*just beyond kiss_fftr_state struct */
-    st->tmpbuf = (kiss_fft_cpx *) (((char *) st->substate) + subsize);
-    st->super_twiddles = st->tmpbuf + nfft;
-    kiss_fft_alloc(nfft, inverse_fft, st->substate, &subsize);
+    st->super_twiddles = (kiss_fft_cpx *) (((char *) st->substate) + subsize);
+    kiss_fft_alloc_flags(nfft, inverse_fft, flags, st->substate, &subsize);
 
     for (i = 0; i < nfft/2; ++i) {
         double phase =
@@ -64,11 +83,59 @@ kiss_fftr_cfg kiss_fftr_alloc(int nfft,int inverse_fft,void * mem,size_t * lenme
     return st;
 }
 
+#ifdef KISS_FFT_X86_SIMD
+/*
+ * Split step of kiss_fftr, two bins per iteration. Bin k pairs with
+ * ncfft-k, so the upper half is loaded and stored with its two complex
+ * values swapped. Only bins below nbins are stored, and the loop stops
+ * where the lower ones run out. Returns the first k left for the scalar
+ * loop.
+ */
+static __attribute__((target("sse2")))
+int kf_fftr_split_sse2(kiss_fftr_cfg st, const kiss_fft_cpx *tmpbuf, kiss_fft_cpx *freqdata, int ncfft, int nbins)
+{
+    const __m128 half = _mm_set1_ps(.5f);
+    const __m128 neg_im = _mm_castsi128_ps(_mm_set_epi32((int)0x80000000, 0, (int)0x80000000, 0));
+    const __m128 neg_re = _mm_castsi128_ps(_mm_set_epi32(0, (int)0x80000000, 0, (int)0x80000000));
+    int k;
+    for (k = 1; k + 1 <= ncfft / 2 && k + 1 < nbins; k += 2) {
+        __m128 fpk = _mm_loadu_ps((const float*)(tmpbuf + k));
+        __m128 fpnk = _mm_loadu_ps((const float*)(tmpbuf + ncfft - k - 1));
+        __m128 tw = _mm_loadu_ps((float*)(st->super_twiddles + k - 1));
+        __m128 f1k, f2k, t, tr, ti, fs;
+        fpnk = _mm_xor_ps(_mm_shuffle_ps(fpnk, fpnk, _MM_SHUFFLE(1,0,3,2)), neg_im);
+        f1k = _mm_add_ps(fpk, fpnk);
+        f2k = _mm_sub_ps(fpk, fpnk);
+        tr = _mm_shuffle_ps(tw, tw, _MM_SHUFFLE(2,2,0,0));
+        ti = _mm_shuffle_ps(tw, tw, _MM_SHUFFLE(3,3,1,1));
+        fs = _mm_shuffle_ps(f2k, f2k, _MM_SHUFFLE(2,3,0,1));
+        t = _mm_add_ps(_mm_mul_ps(f2k, tr), _mm_xor_ps(_mm_mul_ps(fs, ti), neg_re));
+        _mm_storeu_ps((float*)(freqdata + k), _mm_mul_ps(_mm_add_ps(f1k, t), half));
+        t = _mm_xor_ps(_mm_mul_ps(_mm_sub_ps(f1k, t), half), neg_im);
+        t = _mm_shuffle_ps(t, t, _MM_SHUFFLE(1,0,3,2));
+        if (ncfft - k < nbins)
+            _mm_storeu_ps((float*)(freqdata + ncfft - k - 1), t);
+        else if (ncfft - k - 1 < nbins)
+            _mm_storel_pi((__m64*)(freqdata + ncfft - k - 1), t);
+    }
+    return k;
+}
+#endif
+
 void kiss_fftr(kiss_fftr_cfg st,const kiss_fft_scalar *timedata,kiss_fft_cpx *freqdata)
+{
+    void * scratch;
+    KF_SCRATCH_ALLOC(scratch, sizeof(kiss_fft_cpx) * st->substate->nfft);
+    kiss_fftr_scratch(st, timedata, freqdata, scratch);
+    KISS_FFT_TMP_FREE(scratch);
+}
+
+void kiss_fftr_scratch(kiss_fftr_cfg st,const kiss_fft_scalar *timedata,kiss_fft_cpx *freqdata,void *scratch)
 {
     /* input buffer timedata is stored row-wise */
     int k,ncfft;
     kiss_fft_cpx fpnk,fpk,f1k,f2k,tw,tdc;
+    kiss_fft_cpx * tmpbuf = (kiss_fft_cpx*)scratch;
 
     if ( st->substate->inverse) {
         fprintf(stderr,"kiss fft usage error: improper alloc\n");
@@ -78,8 +145,8 @@ void kiss_fftr(kiss_fftr_cfg st,const kiss_fft_scalar *timedata,kiss_fft_cpx *fr
     ncfft = st->substate->nfft;
 
     /*perform the parallel fft of two real signals packed in real,imag*/
-    kiss_fft( st->substate , (const kiss_fft_cpx*)timedata, st->tmpbuf );
-    /* The real part of the DC element of the frequency spectrum in st->tmpbuf
+    kiss_fft( st->substate , (const kiss_fft_cpx*)timedata, tmpbuf );
+    /* The real part of the DC element of the frequency spectrum in tmpbuf
      * contains the sum of the even-numbered elements of the input time sequence
      * The imag part is the sum of the odd-numbered elements
      *
@@ -89,8 +156,8 @@ void kiss_fftr(kiss_fftr_cfg st,const kiss_fft_scalar *timedata,kiss_fft_cpx *fr
      *      yielding Nyquist bin of input time sequence
      */
  
-    tdc.r = st->tmpbuf[0].r;
-    tdc.i = st->tmpbuf[0].i;
+    tdc.r = tmpbuf[0].r;
+    tdc.i = tmpbuf[0].i;
     C_FIXDIV(tdc,2);
     CHECK_OVERFLOW_OP(tdc.r ,+, tdc.i);
     CHECK_OVERFLOW_OP(tdc.r ,-, tdc.i);
@@ -102,10 +169,15 @@ void kiss_fftr(kiss_fftr_cfg st,const kiss_fft_scalar *timedata,kiss_fft_cpx *fr
     freqdata[ncfft].i = freqdata[0].i = 0;
 #endif
 
-    for ( k=1;k <= ncfft/2 ; ++k ) {
-        fpk    = st->tmpbuf[k]; 
-        fpnk.r =   st->tmpbuf[ncfft-k].r;
-        fpnk.i = - st->tmpbuf[ncfft-k].i;
+    k = 1;
+#ifdef KISS_FFT_X86_SIMD
+    if (st->substate->simd != KISS_FFT_SIMD_NONE)
+        k = kf_fftr_split_sse2(st, tmpbuf, freqdata, ncfft, ncfft + 1);
+#endif
+    for ( ;k <= ncfft/2 ; ++k ) {
+        fpk    = tmpbuf[k]; 
+        fpnk.r =   tmpbuf[ncfft-k].r;
+        fpnk.i = - tmpbuf[ncfft-k].i;
         C_FIXDIV(fpk,2);
         C_FIXDIV(fpnk,2);
 
@@ -120,10 +192,252 @@ void kiss_fftr(kiss_fftr_cfg st,const kiss_fft_scalar *timedata,kiss_fft_cpx *fr
     }
 }
 
+#ifdef KISS_FFT_X86_SIMD
+#define KFB_W 4
+#define KFB_TARGET __attribute__((target("sse2")))
+#define KFB_NAME(x) kfb_sse2_##x
+#include "_kiss_fftr_batch.h"
+#undef KFB_W
+#undef KFB_TARGET
+#undef KFB_NAME
+
+#define KFB_W 8
+#define KFB_TARGET __attribute__((target("avx2")))
+#define KFB_NAME(x) kfb_avx2_##x
+#include "_kiss_fftr_batch.h"
+#undef KFB_W
+#undef KFB_TARGET
+#undef KFB_NAME
+
+/* the frame-parallel kernels only have radix 2, 4 and 8 butterflies */
+static int kfb_supported(kiss_fftr_cfg st)
+{
+    const int * factors = st->substate->factors;
+    do {
+        if (factors[0] != 2 && factors[0] != 4 && factors[0] != 8)
+            return 0;
+        factors += 2;
+    } while (factors[-1] > 1);
+    return st->substate->simd != KISS_FFT_SIMD_NONE;
+}
+#endif
+
+/* split step of kiss_fftr for the first nbins bins, from the packed transform */
+static void kf_fftr_split_pruned(kiss_fftr_cfg st,const kiss_fft_cpx *tmpbuf,kiss_fft_cpx *freqdata,int nbins)
+{
+    int k,ncfft;
+    kiss_fft_cpx fpnk,fpk,f1k,f2k,tw,tdc;
+
+    ncfft = st->substate->nfft;
+
+    tdc.r = tmpbuf[0].r;
+    tdc.i = tmpbuf[0].i;
+    C_FIXDIV(tdc,2);
+    freqdata[0].r = tdc.r + tdc.i;
+    freqdata[0].i = 0;
+    if (nbins > ncfft) {
+        freqdata[ncfft].r = tdc.r - tdc.i;
+        freqdata[ncfft].i = 0;
+    }
+
+    /* same split as kiss_fftr, skipping the pairs where neither bin is wanted */
+    k = 1;
+#ifdef KISS_FFT_X86_SIMD
+    if (st->substate->simd != KISS_FFT_SIMD_NONE)
+        k = kf_fftr_split_sse2(st, tmpbuf, freqdata, ncfft, nbins);
+#endif
+    for ( ; k <= ncfft/2; ++k) {
+        if (k >= nbins && ncfft-k >= nbins)
+            k = ncfft - nbins;  /* jump to where the upper bins come into range */
+        else {
+            fpk    = tmpbuf[k];
+            fpnk.r =   tmpbuf[ncfft-k].r;
+            fpnk.i = - tmpbuf[ncfft-k].i;
+            C_FIXDIV(fpk,2);
+            C_FIXDIV(fpnk,2);
+
+            C_ADD( f1k, fpk , fpnk );
+            C_SUB( f2k, fpk , fpnk );
+            C_MUL( tw , f2k , st->super_twiddles[k-1]);
+
+            if (k < nbins) {
+                freqdata[k].r = HALF_OF(f1k.r + tw.r);
+                freqdata[k].i = HALF_OF(f1k.i + tw.i);
+            }
+            if (ncfft-k < nbins) {
+                freqdata[ncfft-k].r = HALF_OF(f1k.r - tw.r);
+                freqdata[ncfft-k].i = HALF_OF(tw.i - f1k.i);
+            }
+        }
+    }
+}
+
+void kiss_fftr_pruned(kiss_fftr_cfg st,const kiss_fft_scalar *timedata,kiss_fft_cpx *freqdata,int nbins)
+{
+    void * scratch;
+    KF_SCRATCH_ALLOC(scratch, sizeof(kiss_fft_cpx) * st->substate->nfft);
+    kiss_fftr_pruned_scratch(st, timedata, freqdata, nbins, scratch);
+    KISS_FFT_TMP_FREE(scratch);
+}
+
+void kiss_fftr_pruned_scratch(kiss_fftr_cfg st,const kiss_fft_scalar *timedata,kiss_fft_cpx *freqdata,int nbins,void *scratch)
+{
+    int ncfft;
+    kiss_fft_cpx * tmpbuf = (kiss_fft_cpx*)scratch;
+
+    if ( st->substate->inverse) {
+        fprintf(stderr,"kiss fft usage error: improper alloc\n");
+        exit(1);
+    }
+
+    ncfft = st->substate->nfft;
+    if (nbins > ncfft + 1)
+        nbins = ncfft + 1;
+    if (nbins < 1)
+        return;
+
+    /* bin k needs packed bins k and ncfft-k: a cyclic band of nbins */
+    kiss_fft_pruned( st->substate , (const kiss_fft_cpx*)timedata, tmpbuf, nbins );
+    kf_fftr_split_pruned(st, tmpbuf, freqdata, nbins);
+}
+
+/* out = in times window for n scalars, window in Q15 in fixed point */
+static void kf_window_run(kiss_fft_scalar * restrict out,const kiss_fft_scalar * restrict in,
+                          const kiss_fft_scalar * restrict window,int n)
+{
+    int k;
+    for (k = 0; k < n; ++k)
+#ifdef FIXED_POINT
+        out[k] = sround( smul(in[k], window[k]) );
+#else
+        out[k] = in[k] * window[k];
+#endif
+}
+
+void kiss_fftr_windowed(kiss_fftr_cfg st,const kiss_fft_scalar *ring,int start,
+                        const kiss_fft_scalar *window,kiss_fft_cpx *freqdata,int nbins)
+{
+    void * scratch;
+    KF_SCRATCH_ALLOC(scratch, sizeof(kiss_fft_cpx) * 2 * st->substate->nfft);
+    kiss_fftr_windowed_scratch(st, ring, start, window, freqdata, nbins, scratch);
+    KISS_FFT_TMP_FREE(scratch);
+}
+
+void kiss_fftr_windowed_scratch(kiss_fftr_cfg st,const kiss_fft_scalar *ring,int start,
+                                const kiss_fft_scalar *window,kiss_fft_cpx *freqdata,int nbins,
+                                void *scratch)
+{
+    int ncfft, nfft;
+    kiss_fft_cpx * packed = (kiss_fft_cpx*)scratch;
+    kiss_fft_cpx * tmpbuf;
+
+    if ( st->substate->inverse) {
+        fprintf(stderr,"kiss fft usage error: improper alloc\n");
+        exit(1);
+    }
+
+    ncfft = st->substate->nfft;
+    nfft = 2 * ncfft;
+    if (nbins > ncfft + 1)
+        nbins = ncfft + 1;
+    if (nbins < 1)
+        return;
+
+    tmpbuf = packed + ncfft;
+
+    /* unroll the ring and window it in one pass, straight into the
+       packed input of the complex transform */
+    kf_window_run((kiss_fft_scalar*)packed, ring + start, window, nfft - start);
+    kf_window_run((kiss_fft_scalar*)packed + nfft - start, ring, window + nfft - start, start);
+
+    kiss_fft_pruned( st->substate , packed, tmpbuf, nbins );
+    kf_fftr_split_pruned(st, tmpbuf, freqdata, nbins);
+}
+
+/* frames per SIMD batch step and the scratch it takes, 0 without one */
+static int kfb_width(kiss_fftr_cfg st)
+{
+#ifdef KISS_FFT_X86_SIMD
+    if (kfb_supported(st))
+        return st->substate->simd == KISS_FFT_SIMD_AVX2 ? 8 : 4;
+#endif
+    (void)st;
+    return 0;
+}
+
+#define KFB_ALIGN 32
+
+static size_t kfb_scratch_size(kiss_fftr_cfg st)
+{
+    /* 2*ncfft vectors of width frames, real and imag */
+    return sizeof(float) * 2 * 2 * (size_t)st->substate->nfft * kfb_width(st) + KFB_ALIGN;
+}
+
+size_t kiss_fftr_scratch_size(kiss_fftr_cfg st)
+{
+    size_t single = sizeof(kiss_fft_cpx) * 2 * (size_t)st->substate->nfft;
+    size_t batch = kfb_scratch_size(st);
+    return single > batch ? single : batch;
+}
+
+void kiss_fftr_batch(kiss_fftr_cfg st,const kiss_fft_scalar *timedata,kiss_fft_cpx *freqdata,
+                     int nframes,int in_stride,int out_stride)
+{
+    void * scratch;
+    size_t bytes = kfb_scratch_size(st);
+    if (bytes < sizeof(kiss_fft_cpx) * (size_t)st->substate->nfft)
+        bytes = sizeof(kiss_fft_cpx) * (size_t)st->substate->nfft;
+    KF_SCRATCH_ALLOC(scratch, bytes);
+    kiss_fftr_batch_scratch(st, timedata, freqdata, nframes, in_stride, out_stride, scratch);
+    KISS_FFT_TMP_FREE(scratch);
+}
+
+void kiss_fftr_batch_scratch(kiss_fftr_cfg st,const kiss_fft_scalar *timedata,kiss_fft_cpx *freqdata,
+                             int nframes,int in_stride,int out_stride,void *scratch)
+{
+    int frame = 0;
+
+    if ( st->substate->inverse) {
+        fprintf(stderr,"kiss fft usage error: improper alloc\n");
+        exit(1);
+    }
+
+#ifdef KISS_FFT_X86_SIMD
+    const int width = kfb_width(st);
+    if (width > 0 && nframes >= width) {
+        char * mem = (char*)scratch;
+        void * vectors = mem + ((KFB_ALIGN - ((size_t)mem & (KFB_ALIGN - 1))) & (KFB_ALIGN - 1));
+
+        for (; frame + width <= nframes; frame += width) {
+            const kiss_fft_scalar * in = timedata + (size_t)frame * in_stride;
+            kiss_fft_cpx * out = freqdata + (size_t)frame * out_stride;
+            if (width == 8)
+                kfb_avx2_frames(st, in, out, in_stride, out_stride, vectors);
+            else
+                kfb_sse2_frames(st, in, out, in_stride, out_stride, vectors);
+        }
+    }
+#endif
+
+    /* whatever did not fill a whole vector of frames */
+    for (; frame < nframes; ++frame)
+        kiss_fftr_scratch(st, timedata + (size_t)frame * in_stride,
+                          freqdata + (size_t)frame * out_stride, scratch);
+}
+
 void kiss_fftri(kiss_fftr_cfg st,const kiss_fft_cpx *freqdata,kiss_fft_scalar *timedata)
+{
+    void * scratch;
+    KF_SCRATCH_ALLOC(scratch, sizeof(kiss_fft_cpx) * st->substate->nfft);
+    kiss_fftri_scratch(st, freqdata, timedata, scratch);
+    KISS_FFT_TMP_FREE(scratch);
+}
+
+void kiss_fftri_scratch(kiss_fftr_cfg st,const kiss_fft_cpx *freqdata,kiss_fft_scalar *timedata,void *scratch)
 {
     /* input buffer timedata is stored row-wise */
     int k, ncfft;
+    kiss_fft_cpx * tmpbuf = (kiss_fft_cpx*)scratch;
 
     if (st->substate->inverse == 0) {
         fprintf (stderr, "kiss fft usage error: improper alloc\n");
@@ -132,9 +446,9 @@ void kiss_fftri(kiss_fftr_cfg st,const kiss_fft_cpx *freqdata,kiss_fft_scalar *t
 
     ncfft = st->substate->nfft;
 
-    st->tmpbuf[0].r = freqdata[0].r + freqdata[ncfft].r;
-    st->tmpbuf[0].i = freqdata[0].r - freqdata[ncfft].r;
-    C_FIXDIV(st->tmpbuf[0],2);
+    tmpbuf[0].r = freqdata[0].r + freqdata[ncfft].r;
+    tmpbuf[0].i = freqdata[0].r - freqdata[ncfft].r;
+    C_FIXDIV(tmpbuf[0],2);
 
     for (k = 1; k <= ncfft / 2; ++k) {
         kiss_fft_cpx fk, fnkc, fek, fok, tmp;
@@ -147,13 +461,13 @@ void kiss_fftri(kiss_fftr_cfg st,const kiss_fft_cpx *freqdata,kiss_fft_scalar *t
         C_ADD (fek, fk, fnkc);
         C_SUB (tmp, fk, fnkc);
         C_MUL (fok, tmp, st->super_twiddles[k-1]);
-        C_ADD (st->tmpbuf[k],     fek, fok);
-        C_SUB (st->tmpbuf[ncfft - k], fek, fok);
+        C_ADD (tmpbuf[k],     fek, fok);
+        C_SUB (tmpbuf[ncfft - k], fek, fok);
 #ifdef USE_SIMD        
-        st->tmpbuf[ncfft - k].i *= _mm_set1_ps(-1.0);
+        tmpbuf[ncfft - k].i *= _mm_set1_ps(-1.0);
 #else
-        st->tmpbuf[ncfft - k].i *= -1;
+        tmpbuf[ncfft - k].i *= -1;
 #endif
     }
-    kiss_fft (st->substate, st->tmpbuf, (kiss_fft_cpx *) timedata);
+    kiss_fft (st->substate, tmpbuf, (kiss_fft_cpx *) timedata);
 }
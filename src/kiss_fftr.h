@@ -25,6 +25,11 @@ kiss_fftr_cfg kiss_fftr_alloc(int nfft,int inverse_fft,void * mem, size_t * lenm
  If you don't care to allocate space, use mem = lenmem = NULL
 */
 
+kiss_fftr_cfg kiss_fftr_alloc_flags(int nfft,int inverse_fft,int flags,void * mem, size_t * lenmem);
+/*
+ Same as kiss_fftr_alloc, flags as for kiss_fft_alloc_flags
+*/
+
 
 void kiss_fftr(kiss_fftr_cfg cfg,const kiss_fft_scalar *timedata,kiss_fft_cpx *freqdata);
 /*
@@ -32,12 +37,61 @@ void kiss_fftr(kiss_fftr_cfg cfg,const kiss_fft_scalar *timedata,kiss_fft_cpx *f
  output freqdata has nfft/2+1 complex points
 */
 
+void kiss_fftr_batch(kiss_fftr_cfg cfg,const kiss_fft_scalar *timedata,kiss_fft_cpx *freqdata,
+                     int nframes,int in_stride,int out_stride);
+/*
+ transform nframes real frames in one call.
+ frame f reads nfft scalars from timedata + f*in_stride and writes nfft/2+1
+ complex points to freqdata + f*out_stride (strides in elements, so
+ in_stride < nfft reads overlapping frames).
+ On SSE2/AVX2 machines 4 or 8 frames at a time share each butterfly
+ instruction; otherwise this is a loop over kiss_fftr.
+*/
+
+void kiss_fftr_pruned(kiss_fftr_cfg cfg,const kiss_fft_scalar *timedata,kiss_fft_cpx *freqdata,int nbins);
+/*
+ output pruned version of kiss_fftr, only the first nbins complex points
+ (out of nfft/2+1) are computed and written to freqdata.
+ The inner complex transform can skip butterflies once nbins is well below
+ nfft/4; for wider bands the saving is the split step of the bins left out.
+*/
+
+void kiss_fftr_windowed(kiss_fftr_cfg cfg,const kiss_fft_scalar *ring,int start,
+                        const kiss_fft_scalar *window,kiss_fft_cpx *freqdata,int nbins);
+/*
+ kiss_fftr_pruned of the nfft scalars of ring starting at ring[start] (and
+ wrapping around, ring holds nfft scalars) times window[0..nfft-1], Q15 in
+ fixed point. The window is applied while the first stage loads its input,
+ so a ring buffer of the latest samples is transformed without shifting
+ or windowing it first.
+*/
+
 void kiss_fftri(kiss_fftr_cfg cfg,const kiss_fft_cpx *freqdata,kiss_fft_scalar *timedata);
 /*
  input freqdata has  nfft/2+1 complex points
  output timedata has nfft scalar points
 */
 
+size_t kiss_fftr_scratch_size(kiss_fftr_cfg cfg);
+/*
+ bytes of scratch any kiss_fftr*_scratch call below needs with cfg.
+ The plain calls allocate (and free) their scratch on every call; the
+ _scratch ones take it from the caller, so a real-time thread can keep one
+ buffer per cfg size and never allocate. No alignment is required.
+*/
+
+void kiss_fftr_scratch(kiss_fftr_cfg cfg,const kiss_fft_scalar *timedata,kiss_fft_cpx *freqdata,
+                       void *scratch);
+void kiss_fftr_batch_scratch(kiss_fftr_cfg cfg,const kiss_fft_scalar *timedata,kiss_fft_cpx *freqdata,
+                             int nframes,int in_stride,int out_stride,void *scratch);
+void kiss_fftr_pruned_scratch(kiss_fftr_cfg cfg,const kiss_fft_scalar *timedata,kiss_fft_cpx *freqdata,
+                              int nbins,void *scratch);
+void kiss_fftr_windowed_scratch(kiss_fftr_cfg cfg,const kiss_fft_scalar *ring,int start,
+                                const kiss_fft_scalar *window,kiss_fft_cpx *freqdata,int nbins,
+                                void *scratch);
+void kiss_fftri_scratch(kiss_fftr_cfg cfg,const kiss_fft_cpx *freqdata,kiss_fft_scalar *timedata,
+                        void *scratch);
+
 #define kiss_fftr_free free
 
 #ifdef __cplusplus
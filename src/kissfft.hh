@@ -1,6 +1,8 @@
 #ifndef KISSFFT_CLASS_HH
+#define KISSFFT_CLASS_HH
 #include <complex>
 #include <vector>
+#include <cstddef>
 
 namespace kissfft_utils {
 
@@ -27,12 +29,13 @@ struct traits
         dst = _twiddles;
 
         //factorize
-        //start factoring out 4's, then 2's, then 3,5,7,9,...
+        //start factoring out 8's, then 4's, then 2's, then 3,5,7,9,...
         int n= nfft;
-        int p=4;
+        int p=8;
         do {
             while (n % p) {
                 switch (p) {
+                    case 8: p = 4; break;
                     case 4: p = 2; break;
                     case 2: p = 3; break;
                     default: p += 2; break;
@@ -106,6 +109,7 @@ class kissfft
                 case 3: kf_bfly3(Fout,fstride,m); break;
                 case 4: kf_bfly4(Fout,fstride,m); break;
                 case 5: kf_bfly5(Fout,fstride,m); break;
+                case 8: kf_bfly8(Fout,fstride,m); break;
                 default: kf_bfly_generic(Fout,fstride,m,p); break;
             }
         }
@@ -151,6 +155,47 @@ class kissfft
             }
         }
 
+        // -i*z forward, +i*z inverse
+        cpx_type rot( const cpx_type & z)
+        {
+            return _inverse ? cpx_type( -z.imag(), z.real() ) : cpx_type( z.imag(), -z.real() );
+        }
+
+        // radix-8 as two radix-4 DFTs of the even and odd inputs;
+        // W8 and W8^3 only need a rotation and a scaling by cos(pi/4)
+        void kf_bfly8( cpx_type * Fout, const size_t fstride, const size_t m)
+        {
+            cpx_type x[8], e[4], o[4], t0, t1, t2, t3;
+            const scalar_type c = _traits.twiddle(fstride*m).real();
+            for (size_t k=0;k<m;++k) {
+                x[0] = Fout[k];
+                for (int q=1;q<8;++q)
+                    x[q] = Fout[k+q*m] * _traits.twiddle(q*k*fstride);
+
+                for (int q=0;q<2;++q) {
+                    cpx_type * d = q ? o : e;
+                    const cpx_type * a = x + q;
+                    t0 = a[0] + a[4];
+                    t1 = a[0] - a[4];
+                    t2 = a[2] + a[6];
+                    t3 = rot( a[2] - a[6] );
+                    d[0] = t0 + t2;
+                    d[2] = t0 - t2;
+                    d[1] = t1 + t3;
+                    d[3] = t1 - t3;
+                }
+
+                o[1] = (o[1] + rot(o[1])) * c;
+                o[2] = rot(o[2]);
+                o[3] = (rot(o[3]) - o[3]) * c;
+
+                for (int q=0;q<4;++q) {
+                    Fout[k+q*m] = e[q] + o[q];
+                    Fout[k+(q+4)*m] = e[q] - o[q];
+                }
+            }
+        }
+
         void kf_bfly3( cpx_type * Fout, const size_t fstride, const size_t m)
         {
             size_t k=m;
@@ -296,4 +341,295 @@ class kissfft
         std::vector<int> _stageRemainder;
         traits_type _traits;
 };
+
+/*
+ * kissfft_fixed<T,N,Inverse>
+ *
+ * The same algorithm as kissfft for a size known at compile time. The
+ * twiddles are a constexpr table and the factorization is unrolled into
+ * nested templates, one per stage, so every stage is a direct call the
+ * compiler can inline, with fstride and m as constants. There is nothing
+ * to allocate; transform() is static and the class has no state.
+ *
+ *     kissfft_fixed<float, 1024>::transform(src, dst);
+ */
+namespace kissfft_fixed_utils {
+
+// compile time sin/cos by Taylor series, x in [-pi, pi]
+constexpr double sin_series(double x2, double term, int n)
+{
+    return n > 30 ? 0 : term + sin_series(x2, -term * x2 / ((2*n+2) * (2*n+3)), n+1);
+}
+
+constexpr double cos_series(double x2, double term, int n)
+{
+    return n > 30 ? 0 : term + cos_series(x2, -term * x2 / ((2*n+1) * (2*n+2)), n+1);
+}
+
+// phase of twiddle i, folded into [-pi, pi]
+constexpr double twiddle_phase(int i, int nfft, bool inverse)
+{
+    return (inverse ? 2 : -2) * 3.141592653589793238462643383279502884 *
+        (2*i > nfft ? i - nfft : i) / nfft;
+}
+
+template <typename T>
+constexpr std::complex<T> twiddle(int i, int nfft, bool inverse)
+{
+    return std::complex<T>(
+            (T) cos_series(twiddle_phase(i, nfft, inverse) * twiddle_phase(i, nfft, inverse), 1, 0),
+            (T) sin_series(twiddle_phase(i, nfft, inverse) * twiddle_phase(i, nfft, inverse),
+                           twiddle_phase(i, nfft, inverse), 0));
+}
+
+// 0..N-1 as a parameter pack, built in log(N) template depth
+template <int... I> struct index_list { typedef index_list type; };
+
+template <class A, class B> struct join_indices;
+template <int... I, int... J>
+struct join_indices< index_list<I...>, index_list<J...> >
+    : index_list<I..., (int)sizeof...(I) + J...> {};
+
+template <int N> struct make_indices
+    : join_indices< typename make_indices<N/2>::type, typename make_indices<N-N/2>::type > {};
+template <> struct make_indices<0> : index_list<> {};
+template <> struct make_indices<1> : index_list<0> {};
+
+template <typename T, int N, bool Inverse, class Idx = typename make_indices<N>::type>
+struct twiddle_table;
+
+template <typename T, int N, bool Inverse, int... I>
+struct twiddle_table<T, N, Inverse, index_list<I...> >
+{
+    static constexpr std::complex<T> value[N] = { twiddle<T>(I, N, Inverse)... };
+};
+
+template <typename T, int N, bool Inverse, int... I>
+constexpr std::complex<T> twiddle_table<T, N, Inverse, index_list<I...> >::value[N];
+
+// same order as traits::prepare: 8's, 4's, 2's, then 3,5,7,9,...
+constexpr int odd_radix(int n, int p)
+{
+    return p*p > n ? n : (n % p == 0 ? p : odd_radix(n, p+2));
+}
+
+constexpr int stage_radix(int n)
+{
+    return n % 8 == 0 ? 8 : n % 4 == 0 ? 4 : n % 2 == 0 ? 2 : odd_radix(n, 3);
+}
+
+// -i*z forward, +i*z inverse
+template <bool Inverse, typename C>
+inline C rot(const C & z)
+{
+    return Inverse ? C( -z.imag(), z.real() ) : C( z.imag(), -z.real() );
+}
+
+// butterflies of one stage, radix P, M of them, twiddles Fstride apart
+template <typename T, int N, bool Inverse, int P, int Fstride, int M>
+struct bfly
+{
+    typedef std::complex<T> cpx_type;
+    static void run(cpx_type * Fout)
+    {
+        const cpx_type * tw = twiddle_table<T, N, Inverse>::value;
+        cpx_type scratch[P];
+        for (int u=0;u<M;++u) {
+            for (int q1=0;q1<P;++q1)
+                scratch[q1] = Fout[u + q1*M];
+            for (int q1=0;q1<P;++q1) {
+                const int k = u + q1*M;
+                int twidx = 0;
+                Fout[k] = scratch[0];
+                for (int q=1;q<P;++q) {
+                    twidx += Fstride * k;
+                    if (twidx >= N) twidx -= N;
+                    Fout[k] += scratch[q] * tw[twidx];
+                }
+            }
+        }
+    }
+};
+
+template <typename T, int N, bool Inverse, int Fstride, int M>
+struct bfly<T, N, Inverse, 2, Fstride, M>
+{
+    typedef std::complex<T> cpx_type;
+    static void run(cpx_type * Fout)
+    {
+        const cpx_type * tw = twiddle_table<T, N, Inverse>::value;
+        for (int k=0;k<M;++k) {
+            cpx_type t = Fout[M+k] * tw[k*Fstride];
+            Fout[M+k] = Fout[k] - t;
+            Fout[k] += t;
+        }
+    }
+};
+
+template <typename T, int N, bool Inverse, int Fstride, int M>
+struct bfly<T, N, Inverse, 3, Fstride, M>
+{
+    typedef std::complex<T> cpx_type;
+    static void run(cpx_type * Fout)
+    {
+        const cpx_type * tw = twiddle_table<T, N, Inverse>::value;
+        const T epi3 = tw[Fstride*M].imag();
+        for (int k=0;k<M;++k) {
+            cpx_type s1 = Fout[k+M] * tw[k*Fstride];
+            cpx_type s2 = Fout[k+2*M] * tw[2*k*Fstride];
+            cpx_type s3 = s1 + s2;
+            cpx_type s0 = (s1 - s2) * epi3;
+            Fout[k+M] = Fout[k] - s3 * T(.5);
+            Fout[k] += s3;
+            Fout[k+2*M] = cpx_type( Fout[k+M].real() + s0.imag(), Fout[k+M].imag() - s0.real() );
+            Fout[k+M] += cpx_type( -s0.imag(), s0.real() );
+        }
+    }
+};
+
+template <typename T, int N, bool Inverse, int Fstride, int M>
+struct bfly<T, N, Inverse, 4, Fstride, M>
+{
+    typedef std::complex<T> cpx_type;
+    static void run(cpx_type * Fout)
+    {
+        const cpx_type * tw = twiddle_table<T, N, Inverse>::value;
+        for (int k=0;k<M;++k) {
+            cpx_type s0 = Fout[k+M] * tw[k*Fstride];
+            cpx_type s1 = Fout[k+2*M] * tw[2*k*Fstride];
+            cpx_type s2 = Fout[k+3*M] * tw[3*k*Fstride];
+            cpx_type s5 = Fout[k] - s1;
+            Fout[k] += s1;
+            cpx_type s3 = s0 + s2;
+            cpx_type s4 = rot<Inverse>(s0 - s2);
+            Fout[k+2*M] = Fout[k] - s3;
+            Fout[k] += s3;
+            Fout[k+M] = s5 + s4;
+            Fout[k+3*M] = s5 - s4;
+        }
+    }
+};
+
+template <typename T, int N, bool Inverse, int Fstride, int M>
+struct bfly<T, N, Inverse, 5, Fstride, M>
+{
+    typedef std::complex<T> cpx_type;
+    static void run(cpx_type * Fout)
+    {
+        const cpx_type * tw = twiddle_table<T, N, Inverse>::value;
+        const cpx_type ya = tw[Fstride*M];
+        const cpx_type yb = tw[Fstride*2*M];
+        for (int u=0;u<M;++u) {
+            cpx_type s0 = Fout[u];
+            cpx_type s1 = Fout[u+M] * tw[u*Fstride];
+            cpx_type s2 = Fout[u+2*M] * tw[2*u*Fstride];
+            cpx_type s3 = Fout[u+3*M] * tw[3*u*Fstride];
+            cpx_type s4 = Fout[u+4*M] * tw[4*u*Fstride];
+
+            cpx_type s7 = s1 + s4, s10 = s1 - s4;
+            cpx_type s8 = s2 + s3, s9 = s2 - s3;
+            Fout[u] = s0 + s7 + s8;
+
+            cpx_type s5 = s0 + cpx_type( s7.real()*ya.real() + s8.real()*yb.real(),
+                                         s7.imag()*ya.real() + s8.imag()*yb.real() );
+            cpx_type s6 = cpx_type( s10.imag()*ya.imag() + s9.imag()*yb.imag(),
+                                    -s10.real()*ya.imag() - s9.real()*yb.imag() );
+            Fout[u+M] = s5 - s6;
+            Fout[u+4*M] = s5 + s6;
+
+            cpx_type s11 = s0 + cpx_type( s7.real()*yb.real() + s8.real()*ya.real(),
+                                          s7.imag()*yb.real() + s8.imag()*ya.real() );
+            cpx_type s12 = cpx_type( -s10.imag()*yb.imag() + s9.imag()*ya.imag(),
+                                     s10.real()*yb.imag() - s9.real()*ya.imag() );
+            Fout[u+2*M] = s11 + s12;
+            Fout[u+3*M] = s11 - s12;
+        }
+    }
+};
+
+template <typename T, int N, bool Inverse, int Fstride, int M>
+struct bfly<T, N, Inverse, 8, Fstride, M>
+{
+    typedef std::complex<T> cpx_type;
+    static void run(cpx_type * Fout)
+    {
+        const cpx_type * tw = twiddle_table<T, N, Inverse>::value;
+        const T c = tw[Fstride*M].real();
+        for (int k=0;k<M;++k) {
+            cpx_type x[8], e[4], o[4];
+            x[0] = Fout[k];
+            for (int q=1;q<8;++q)
+                x[q] = Fout[k+q*M] * tw[q*k*Fstride];
+
+            for (int q=0;q<2;++q) {
+                cpx_type * d = q ? o : e;
+                const cpx_type * a = x + q;
+                cpx_type t0 = a[0] + a[4], t1 = a[0] - a[4];
+                cpx_type t2 = a[2] + a[6], t3 = rot<Inverse>(a[2] - a[6]);
+                d[0] = t0 + t2;
+                d[2] = t0 - t2;
+                d[1] = t1 + t3;
+                d[3] = t1 - t3;
+            }
+
+            o[1] = (o[1] + rot<Inverse>(o[1])) * c;
+            o[2] = rot<Inverse>(o[2]);
+            o[3] = (rot<Inverse>(o[3]) - o[3]) * c;
+
+            for (int q=0;q<4;++q) {
+                Fout[k+q*M] = e[q] + o[q];
+                Fout[k+(q+4)*M] = e[q] - o[q];
+            }
+        }
+    }
+};
+
+// one stage of the recursion: Len = p*m points, inputs Fstride apart
+template <typename T, int N, bool Inverse, int Fstride, int Len>
+struct stage
+{
+    typedef std::complex<T> cpx_type;
+    static const int p = stage_radix(Len);
+    static const int m = Len / p;
+
+    static void work(cpx_type * Fout, const cpx_type * f, size_t in_stride)
+    {
+        // p instances of smaller DFTs of size m,
+        // each one takes a decimated version of the input
+        for (int q=0;q<p;++q)
+            stage<T, N, Inverse, Fstride*p, m>::work(Fout + q*m, f + q*Fstride*in_stride, in_stride);
+        // recombine the p smaller DFTs
+        bfly<T, N, Inverse, p, Fstride, m>::run(Fout);
+    }
+};
+
+template <typename T, int N, bool Inverse, int Fstride>
+struct stage<T, N, Inverse, Fstride, 1>
+{
+    typedef std::complex<T> cpx_type;
+    static void work(cpx_type * Fout, const cpx_type * f, size_t)
+    {
+        *Fout = *f;
+    }
+};
+
+}
+
+template <typename T_Scalar, int N, bool Inverse=false>
+class kissfft_fixed
+{
+    public:
+        typedef T_Scalar scalar_type;
+        typedef std::complex<scalar_type> cpx_type;
+
+        static void transform(const cpx_type * src , cpx_type * dst)
+        {
+            kissfft_fixed_utils::stage<scalar_type, N, Inverse, 1, N>::work(dst, src, 1);
+        }
+
+        static void transform_stride(const cpx_type * src , cpx_type * dst, size_t in_stride)
+        {
+            kissfft_fixed_utils::stage<scalar_type, N, Inverse, 1, N>::work(dst, src, in_stride);
+        }
+};
 #endif
@@ -0,0 +1,224 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: largeFFT.cpp
+ Description:
+ Cache-blocked, multithreaded four-step FFT for transforms too large for
+ the recursive kiss_fft to run out of cache.
+
+ With N = n1 n2, x viewed as n1 rows of n2 and the output index
+ k = k1 + n1 k2,
+     X[k1 + n1 k2] = sum_j2 W_n2^(j2 k2) W_N^(j2 k1) sum_j1 x[j2 + n2 j1] W_n1^(j1 k1)
+ So the transform is
+     1. transpose x to n2 rows of n1
+     2. n2 FFTs of length n1, row j2 multiplied by W_N^(j2 k1)
+     3. transpose to n1 rows of n2
+     4. n1 FFTs of length n2
+     5. transpose to the natural output order
+ Every FFT runs on a contiguous row that fits in cache, the rows of a step
+ are spread over the thread pool, and the transposes go tile by tile so
+ both the read and the write side stay in cache.
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <math.h>
+
+#include "largeFFT.h"
+#include "_kiss_fft_guts.h"
+
+using namespace std;
+
+// Tile edge of the blocked transpose, two tiles of 32x32 fit in L1
+#define TRANSPOSE_BLOCK 32
+
+largeFFT::largeFFT(int _nfft, bool _inverse, int threads) :
+    nfft(_nfft), n1(0), n2(0), inverse(_inverse), cfg1(NULL), cfg2(NULL),
+    nthreads(1), job(NULL), jobCount(0), pending(0), generation(0), quit(false)
+{
+    // Split into the most square n1 x n2 available
+    if (nfft >= LARGEFFT_MIN_SIZE) {
+        for (int d = (int)sqrt((double)nfft); d >= 16; d--) {
+            if (nfft % d == 0) {
+                n1 = d;
+                n2 = nfft / d;
+                break;
+            }
+        }
+    }
+
+    if (n1 == 0) {
+        // Small or badly factorable size, a single kiss_fft
+        cfg1 = kiss_fft_alloc(nfft, inverse, NULL, NULL);
+    } else {
+        cfg1 = kiss_fft_alloc(n1, inverse, NULL, NULL);
+        cfg2 = kiss_fft_alloc(n2, inverse, NULL, NULL);
+        buf.resize(nfft);
+
+        const double sign = inverse ? 1 : -1;
+        twLo.resize(n1);
+        for (int r = 0; r < n1; r++)
+            kf_cexp(&twLo[r], sign * 2 * M_PI * r / nfft);
+        twHi.resize(n2);
+        for (int q = 0; q < n2; q++)
+            kf_cexp(&twHi[q], sign * 2 * M_PI * q / n2);
+
+        if (threads <= 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        nthreads = threads;
+        for (int i = 1; i < nthreads; i++)
+            pool.push_back(std::thread(&largeFFT::worker, this, i));
+    }
+
+    if (cfg1 == NULL || (n1 != 0 && cfg2 == NULL)) {
+        cerr << "[Error] Not enough memory!" << endl;
+        exit(-1);
+    }
+} /* largeFFT::largeFFT */
+
+largeFFT::~largeFFT()
+{
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        quit = true;
+    }
+    wake.notify_all();
+    for (size_t i = 0; i < pool.size(); i++)
+        pool[i].join();
+
+    kiss_fft_free(cfg1);
+    kiss_fft_free(cfg2);
+} /* largeFFT::~largeFFT */
+
+void
+largeFFT::transform(const kiss_fft_cpx* fin, kiss_fft_cpx* fout)
+{
+    if (n1 == 0) {
+        kiss_fft(cfg1, fin, fout);
+        return;
+    }
+
+    kiss_fft_cpx* const b = &buf[0];
+
+    // 1. x as n1 rows of n2 -> n2 rows of n1
+    transpose(fin, b, n1, n2);
+
+    // 2. FFTs of length n1 and the twiddles, still in cache after the row
+    parallelFor(n2, [&](int begin, int end) {
+        for (int row = begin; row < end; row++) {
+            kiss_fft_cpx* dst = fout + (size_t)row * n1;
+            kiss_fft(cfg1, b + (size_t)row * n1, dst);
+
+            // W^(row k1) = twHi[q] twLo[r] with q n1 + r = row k1
+            const int sq = row / n1, sr = row % n1;
+            int q = 0, r = 0;
+            for (int k1 = 0; k1 < n1; k1++) {
+                kiss_fft_cpx w, t;
+                C_MUL(w, twHi[q], twLo[r]);
+                C_MUL(t, dst[k1], w);
+                dst[k1] = t;
+                q += sq;
+                r += sr;
+                if (r >= n1) {
+                    r -= n1;
+                    q++;
+                }
+            }
+        }
+    });
+
+    // 3. n2 rows of n1 -> n1 rows of n2
+    transpose(fout, b, n2, n1);
+
+    // 4. FFTs of length n2, in place through a row of scratch
+    parallelFor(n1, [&](int begin, int end) {
+        std::vector<kiss_fft_cpx> tmp(n2);
+        for (int row = begin; row < end; row++) {
+            kiss_fft_cpx* src = b + (size_t)row * n2;
+            kiss_fft(cfg2, src, &tmp[0]);
+            std::copy(tmp.begin(), tmp.end(), src);
+        }
+    });
+
+    // 5. X[k1][k2] -> X[k1 + n1 k2]
+    transpose(b, fout, n1, n2);
+} /* largeFFT::transform */
+
+void
+largeFFT::transpose(const kiss_fft_cpx* src, kiss_fft_cpx* dst, int rows, int cols)
+{
+    // Tiles along the source columns, each thread writes its own dst rows
+    const int tiles = (cols + TRANSPOSE_BLOCK - 1) / TRANSPOSE_BLOCK;
+    parallelFor(tiles, [&](int begin, int end) {
+        for (int tc = begin; tc < end; tc++) {
+            const int c0 = tc * TRANSPOSE_BLOCK;
+            const int c1 = std::min(c0 + TRANSPOSE_BLOCK, cols);
+            for (int r0 = 0; r0 < rows; r0 += TRANSPOSE_BLOCK) {
+                const int r1 = std::min(r0 + TRANSPOSE_BLOCK, rows);
+                for (int r = r0; r < r1; r++)
+                    for (int c = c0; c < c1; c++)
+                        dst[(size_t)c * rows + r] = src[(size_t)r * cols + c];
+            }
+        }
+    });
+} /* largeFFT::transpose */
+
+void
+largeFFT::parallelFor(int count, const std::function<void(int, int)>& body)
+{
+    if (nthreads == 1) {
+        body(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        job = &body;
+        jobCount = count;
+        pending = nthreads - 1;
+        generation++;
+    }
+    wake.notify_all();
+
+    // The calling thread takes the first share
+    body(0, count / nthreads);
+
+    std::unique_lock<std::mutex> lock(poolMutex);
+    done.wait(lock, [this] { return pending == 0; });
+} /* largeFFT::parallelFor */
+
+void
+largeFFT::worker(int id)
+{
+    unsigned int seen = 0;
+    std::unique_lock<std::mutex> lock(poolMutex);
+    while (true) {
+        wake.wait(lock, [&] { return quit || generation != seen; });
+        if (quit)
+            return;
+        seen = generation;
+        const std::function<void(int, int)>& body = *job;
+        const long count = jobCount;
+        lock.unlock();
+
+        body((int)(count * id / nthreads), (int)(count * (id + 1) / nthreads));
+
+        lock.lock();
+        if (--pending == 0)
+            done.notify_one();
+    }
+} /* largeFFT::worker */
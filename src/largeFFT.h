@@ -0,0 +1,81 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: largeFFT.h
+ Description:
+ Cache-blocked, multithreaded four-step FFT for transforms too large for
+ the recursive kiss_fft to run out of cache.
+ */
+
+#ifndef LARGEFFT_H
+#define LARGEFFT_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// kissFFT addon include file
+#include "kiss_fft.h"
+
+// Below this size a single kiss_fft fits in cache and is used directly
+#define LARGEFFT_MIN_SIZE 524288
+
+class largeFFT
+{
+public:
+    // Complex FFT of nfft points, same scaling and sign as kiss_fft.
+    // threads is the number of threads running the sub-FFTs, 0 uses all
+    // hardware threads.
+    largeFFT(int nfft, bool inverse, int threads = 0);
+    ~largeFFT();
+
+    // fin and fout may be the same buffer. One transform at a time per
+    // object, as the scratch buffer and the thread pool are shared.
+    void transform(const kiss_fft_cpx* fin, kiss_fft_cpx* fout);
+    int size() const { return nfft; }
+
+private:
+    largeFFT(const largeFFT&) = delete;
+    largeFFT& operator=(const largeFFT&) = delete;
+
+    void transpose(const kiss_fft_cpx* src, kiss_fft_cpx* dst, int rows, int cols);
+    void parallelFor(int count, const std::function<void(int, int)>& body);
+    void worker(int id);
+
+    // nfft = n1 * n2, n1 <= n2; n1 is 0 when nfft is not split
+    int nfft, n1, n2;
+    bool inverse;
+    kiss_fft_cfg cfg1, cfg2;
+    // W^r for r < n1 and W^(q n1) for q < n2, their products give every
+    // twiddle W^(n2 k1) of the middle step
+    std::vector<kiss_fft_cpx> twLo, twHi;
+    std::vector<kiss_fft_cpx> buf;
+
+    // Thread pool, every parallelFor hands one equal share to each thread
+    int nthreads;
+    std::vector<std::thread> pool;
+    std::mutex poolMutex;
+    std::condition_variable wake, done;
+    const std::function<void(int, int)>* job;
+    int jobCount, pending;
+    unsigned int generation;
+    bool quit;
+};
+
+#endif
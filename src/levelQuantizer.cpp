@@ -0,0 +1,58 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: levelQuantizer.cpp
+ Description:
+ Power to 8 bit display level by threshold lookup, no sqrt or log per bin.
+ */
+
+#include <math.h>
+
+#include "levelQuantizer.h"
+
+levelQuantizer::levelQuantizer()
+{
+    setRange(-180, 80);
+} /* levelQuantizer::levelQuantizer */
+
+void
+levelQuantizer::setRange(float floor_db, float max_db, float offset_db)
+{
+    // an empty range is a step at floor_db, as in linestep
+    double step = max_db > floor_db ? ((double)max_db - floor_db) / 255 : 0;
+    threshold[0] = 0;
+    for (int k = 1; k < 256; k++) {
+        double power = pow(10.0, (floor_db + k * step - offset_db) / 10);
+        // round up, so that power >= threshold holds exactly when the
+        // float power is at or above the exact one
+        float t = (float)power;
+        if ((double)t < power)
+            t = nextafterf(t, INFINITY);
+        threshold[k] = t;
+    }
+
+    int l = 0;
+    for (unsigned int b = 0; b < BUCKETS; b++) {
+        unsigned int bits = b << BUCKET_SHIFT;
+        float low;
+        memcpy(&low, &bits, sizeof(low));
+        while (l < 255 && low >= threshold[l + 1])
+            l++;
+        bucket[b] = (unsigned char)l;
+    }
+    bucket[BUCKETS] = 255;
+} /* levelQuantizer::setRange */
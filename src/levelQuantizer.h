@@ -0,0 +1,62 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: levelQuantizer.h
+ Description:
+ Power to 8 bit display level by threshold lookup, no sqrt or log per bin.
+ */
+
+#ifndef LEVELQUANTIZER_H
+#define LEVELQUANTIZER_H
+
+#include <string.h>
+
+// Level k of linestep(10log10(power) + offset_db, floor_db, max_db) * 255,
+// truncated, is reached at a fixed power threshold, so the 255 thresholds
+// are computed once per range and each bin is only compared against them.
+class levelQuantizer
+{
+public:
+    levelQuantizer();
+
+    // offset_db is added to 10log10(power) before the range is applied,
+    // for powers that are not on the float FFT scale
+    void setRange(float floor_db, float max_db, float offset_db = 0);
+
+    // The truncated level 0..255 of power
+    int level(float power) const
+    {
+        unsigned int bits;
+        memcpy(&bits, &power, sizeof(bits));
+        bits = (bits & 0x7fffffff) >> BUCKET_SHIFT;
+        int l = bucket[bits], hi = bucket[bits + 1];
+        while (l < hi && power >= threshold[l + 1])
+            l++;
+        return l;
+    }
+
+private:
+    // a bucket is an exponent and the top 4 mantissa bits of the power,
+    // 1/16 octave; with the default 260 dB range at most one threshold
+    // falls inside one
+    enum { BUCKET_SHIFT = 19, BUCKETS = 1 << (32 - 1 - BUCKET_SHIFT) };
+
+    float threshold[256];               // lowest power of each level, [0] unused
+    unsigned char bucket[BUCKETS + 1];  // level at the bottom of each bucket
+};
+
+#endif
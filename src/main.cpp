@@ -22,6 +22,9 @@
 #include <string>
 #include <opencv2/opencv.hpp>
 #include "soundView.h"
+#include "fftPlan.h"
+#include "fftTuner.h"
+#include "fastFIR.h"
 #include "common.h"
 
 #define SAMPLERATE 44100
@@ -31,7 +34,7 @@ using namespace std;
 void
 help(char* command){
 	std::cout   << "Usage : " << command
-                << "    [-hrp] [-vtfos arguments] [filename]" << endl
+                << "    [-hrpdDcSQ] [-vtfosHbTgzFwmMe arguments] [filename]" << endl
                 << endl
                 << "    -h              : view this help" << endl
                 << "    -r              : record audio from system microphone" << endl
@@ -41,6 +44,26 @@ help(char* command){
                 << "    -f floor_dB     : set the min visualized level(dB), default = -180dB" << endl
                 << "    -o image_file   : save visualized image to file" << endl
                 << "    -s basefile     : compare with basefile and output score" << endl
+                << "    -H hop          : samples between spectogram columns, divides 512, default = 512" << endl
+                << "    -d              : sliding DFT, cheaper than an FFT per column for hops up to ~8," << endl
+                << "                      selects the Hann window" << endl
+                << "    -b backend      : FFT backend, kiss or fftw (if built with FFTW), default = kiss" << endl
+                << "    -T tune_file    : time the FFT backends once and keep the fastest in tune_file," << endl
+                << "                      overrides -b" << endl
+                << "    -g f1,f2,...    : print the levels(dB) at these frequencies(Hz) per frame" << endl
+                << "                      instead of drawing the spectogram" << endl
+                << "    -z f0:f1        : draw only the f0..f1 band(Hz) at full height (chirp-z zoom)" << endl
+                << "    -D              : run the analysis in double precision, for validation" << endl
+                << "    -F taps_file    : FIR filter the input before analysis, taps as text" << endl
+                << "    -c              : print cepstral coefficients and pitch per column" << endl
+                << "    -w window       : kaiser, hann, nuttall or blackmanharris, default = kaiser" << endl
+                << "    -m mode         : interpolate draws the lowest 256 bins, average or max pool" << endl
+                << "                      all 512 bins up to half the sample rate, default = interpolate" << endl
+                << "    -M scale        : draw the rows on the mel or bark scale" << endl
+                << "    -e bands        : print the levels(dB) of this many mel (or -M scale) bands" << endl
+                << "                      per column" << endl
+                << "    -Q              : constant-Q spectogram, 8 octaves of 32 rows from 32.7Hz (C1)" << endl
+                << "    -S              : analyse stereo channels apart, left in red, right in cyan" << endl
                 << "    filename        : input audio file (WAV|OGG|FLAC supported)" << endl
                 << "                      if has '-r', this file is ignored." << endl;
 
@@ -124,10 +147,25 @@ main (int argc, char* argv[])
     bool isScore = false;
     bool isPlayback = false;
     bool isSave = false;
+    unsigned int hopSize = BUFFER_LEN;
+    bool isSlidingDFT = false;
+    std::vector<float> toneFreqs;
+    double zoomLow = 0, zoomHigh = 0;
+    bool isDouble = false;
+    std::vector<float> firTaps;
+    bool isCepstrum = false;
+    bool isPerChannel = false;
+    windowType window = WINDOW_KAISER;
+    bool isWindowSet = false;
+    specMapMode rowMode = SPECMAP_INTERPOLATE;
+    bool isPerceptual = false;
+    filterScale bandScale = SCALE_MEL;
+    int featureBands = 0;
+    bool isConstantQ = false;
     
 
 	int optionChar, prev_ind;
-	while(prev_ind = optind, (optionChar = getopt(argc,argv,"hrpv:t:f:o:s:"))!=EOF){
+	while(prev_ind = optind, (optionChar = getopt(argc,argv,"hrpdDcSQv:t:f:o:s:H:b:T:g:z:F:w:m:M:e:"))!=EOF){
 		if(optind == prev_ind + 2 && *optarg == '-' && atoi(optarg)==0){
 			optionChar = ':';
 			-- optind;
@@ -162,6 +200,93 @@ main (int argc, char* argv[])
                 isScore = true;
                 strcpy(fn_baseAudio, optarg);
                 cout << "Score with         : " << fn_baseAudio << endl;
+                break;
+            case 'H':
+                hopSize = atoi(optarg);
+                cout << "Hop size           : " << hopSize << endl;
+                break;
+            case 'd':
+                isSlidingDFT = true;
+                cout << "Sliding DFT        : " << isSlidingDFT << endl;
+                break;
+            case 'b':
+                if (strcmp(optarg, "kiss") == 0)
+                    fftPlan::setBackend(KISS_FFT_SIMD_AUTO);
+                else if (strcmp(optarg, "fftw") != 0 || !fftPlan::setBackend(FFT_BACKEND_FFTW)) {
+                    cerr << "[Error] FFT backend not available : " << optarg << endl;
+                    return 1;
+                }
+                cout << "FFT backend        : " << optarg << endl;
+                break;
+            case 'T':
+                fftTuner::open(optarg);
+                cout << "FFT tuning file    : " << optarg << endl;
+                break;
+            case 'g':
+                for (char* f = strtok(optarg, ","); f != NULL; f = strtok(NULL, ","))
+                    toneFreqs.push_back(atof(f));
+                cout << "Tone frequencies   : " << toneFreqs.size() << endl;
+                break;
+            case 'F':
+                if (!fastFIR::loadTaps(optarg, firTaps)) {
+                    cerr << "[Error] Cannot read FIR taps : " << optarg << endl;
+                    return 1;
+                }
+                cout << "FIR taps           : " << firTaps.size() << endl;
+                break;
+            case 'c':
+                isCepstrum = true;
+                cout << "Cepstrum           : " << isCepstrum << endl;
+                break;
+            case 'w':
+                if (!windowTypeFromName(optarg, window)) {
+                    cerr << "[Error] Unknown window : " << optarg << endl;
+                    return 1;
+                }
+                isWindowSet = true;
+                cout << "Window             : " << optarg << endl;
+                break;
+            case 'm':
+                if (!specMapModeFromName(optarg, rowMode)) {
+                    cerr << "[Error] Unknown row mapping : " << optarg << endl;
+                    return 1;
+                }
+                cout << "Row mapping        : " << optarg << endl;
+                break;
+            case 'M':
+                if (!filterScaleFromName(optarg, bandScale)) {
+                    cerr << "[Error] Unknown band scale : " << optarg << endl;
+                    return 1;
+                }
+                isPerceptual = true;
+                cout << "Row scale          : " << optarg << endl;
+                break;
+            case 'e':
+                featureBands = atoi(optarg);
+                if (featureBands < 1) {
+                    cerr << "[Error] Band count must be positive." << endl;
+                    return 1;
+                }
+                cout << "Feature bands      : " << featureBands << endl;
+                break;
+            case 'Q':
+                isConstantQ = true;
+                cout << "Constant-Q         : " << isConstantQ << endl;
+                break;
+            case 'S':
+                isPerChannel = true;
+                cout << "Per channel        : " << isPerChannel << endl;
+                break;
+            case 'D':
+                isDouble = true;
+                cout << "Double precision   : " << isDouble << endl;
+                break;
+            case 'z':
+                if (sscanf(optarg, "%lf:%lf", &zoomLow, &zoomHigh) != 2 || zoomHigh <= zoomLow) {
+                    cerr << "[Error] Zoom band must be f0:f1 with f0 < f1." << endl;
+                    return 1;
+                }
+                cout << "Zoom band          : " << zoomLow << " - " << zoomHigh << " Hz" << endl;
                 break;
 			case '?':
 			case ':':
@@ -173,6 +298,15 @@ main (int argc, char* argv[])
 		}
 	}
 
+    // The sliding DFT can only window in the frequency domain, with Hann
+    if (isSlidingDFT) {
+        if (isWindowSet && window != WINDOW_HANN) {
+            cerr << "[Error] The sliding DFT draws Hann windowed columns, use -w hann or no -w." << endl;
+            return 1;
+        }
+        window = WINDOW_HANN;
+    }
+
     // Check whether using microphone, if not, a input audio file is needed
     if (!isRecord) {
         if(optind < argc){
@@ -205,6 +339,21 @@ main (int argc, char* argv[])
         inputParams.outputDevice = paNoDevice;
         inputParams.sampleRate = SAMPLERATE;
     }
+    inputParams.hopSize = hopSize;
+    inputParams.useSlidingDFT = isSlidingDFT;
+    inputParams.toneFreqs = toneFreqs;
+    inputParams.zoomLow = zoomLow;
+    inputParams.zoomHigh = zoomHigh;
+    inputParams.doublePrecision = isDouble;
+    inputParams.firTaps = firTaps;
+    inputParams.useCepstrum = isCepstrum;
+    inputParams.perChannel = isPerChannel;
+    inputParams.window = window;
+    inputParams.rowMode = rowMode;
+    inputParams.perceptualRows = isPerceptual;
+    inputParams.bandScale = bandScale;
+    inputParams.featureBands = featureBands;
+    inputParams.useConstantQ = isConstantQ;
 
     inputView = new soundView(inputParams);
     inputView->setLevels(volume, max_db, floor_db);
@@ -224,6 +373,18 @@ main (int argc, char* argv[])
         scoreParams.inputFilename = new char[ARRAY_LEN(fn_baseAudio)+1];
         strcpy(scoreParams.inputFilename, fn_baseAudio);
         scoreParams.outputDevice = isPlayback ? Pa_GetDefaultOutputDevice() : paNoDevice;
+        scoreParams.hopSize = hopSize;
+        scoreParams.useSlidingDFT = isSlidingDFT;
+        scoreParams.zoomLow = zoomLow;
+        scoreParams.zoomHigh = zoomHigh;
+        scoreParams.doublePrecision = isDouble;
+        scoreParams.firTaps = firTaps;
+        scoreParams.perChannel = isPerChannel;
+        scoreParams.window = window;
+        scoreParams.rowMode = rowMode;
+        scoreParams.perceptualRows = isPerceptual;
+        scoreParams.bandScale = bandScale;
+        scoreParams.useConstantQ = isConstantQ;
         scoreView = new soundView(scoreParams);
         scoreView->setLevels(volume, max_db, floor_db);
 
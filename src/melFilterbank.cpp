@@ -0,0 +1,144 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: melFilterbank.cpp
+ Description:
+ Triangular filterbank on the mel or Bark scale, stored sparse and
+ applied to a power spectrum.
+
+ Every triangle only covers a short run of bins, so a filter is kept as
+ its first bin and the run of weights from there, padded with zeros to a
+ multiple of 4. The product with the spectrum is then one SSE2 dot
+ product per band, without a dense bands x bins matrix.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <algorithm>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "melFilterbank.h"
+
+using namespace std;
+
+static double
+toScale(double hz, filterScale scale)
+{
+    if (scale == SCALE_BARK)
+        return 26.81 * hz / (1960 + hz) - 0.53;
+    return 2595 * log10(1 + hz / 700);
+} /* toScale */
+
+static double
+fromScale(double z, filterScale scale)
+{
+    if (scale == SCALE_BARK)
+        return 1960 * (z + 0.53) / (26.28 - z);
+    return 700 * (pow(10, z / 2595) - 1);
+} /* fromScale */
+
+bool
+filterScaleFromName(const char* name, filterScale& scale)
+{
+    if (strcmp(name, "mel") == 0)
+        scale = SCALE_MEL;
+    else if (strcmp(name, "bark") == 0)
+        scale = SCALE_BARK;
+    else
+        return false;
+    return true;
+} /* filterScaleFromName */
+
+melFilterbank::melFilterbank(int bands, int _nbins, double binHz, filterScale scale) :
+    nbins(_nbins), first(bands), length(bands), offset(bands), centres(bands)
+{
+    if (bands < 1 || nbins < 4) {
+        cerr << "[Error] Filterbank needs a band and at least 4 bins" << endl;
+        exit(-1);
+    }
+
+    // band b rises from edge b to its centre at edge b+1 and falls to edge b+2
+    const double top = toScale((nbins - 1) * binHz, scale);
+    std::vector<double> edge(bands + 2);
+    for (int b = 0; b < bands + 2; b++)
+        edge[b] = fromScale(top * b / (bands + 1), scale) / binHz;
+
+    std::vector<float> w(nbins);
+    for (int b = 0; b < bands; b++) {
+        const double lo = edge[b], mid = edge[b + 1], hi = edge[b + 2];
+        centres[b] = (float)(mid * binHz);
+
+        int a = std::max(0, (int)ceil(lo)), e = std::min(nbins - 1, (int)floor(hi));
+        double sum = 0;
+        for (int k = a; k <= e; k++) {
+            w[k] = (float)(k <= mid ? (k - lo) / (mid - lo) : (hi - k) / (hi - mid));
+            if (w[k] <= 0)
+                w[k] = 0;
+            sum += w[k];
+        }
+        if (sum <= 0) {
+            // Low bands can be narrower than a bin and miss every one,
+            // those interpolate the spectrum at their centre instead
+            a = std::min((int)floor(mid), nbins - 2);
+            e = a + 1;
+            w[e] = (float)(mid - a);
+            w[a] = 1 - w[e];
+            sum = 1;
+        }
+        for (int k = a; k <= e; k++)
+            w[k] = (float)(w[k] / sum);
+
+        // pad to a multiple of 4, moving the start back at the top end so
+        // that no read goes past the last bin
+        int len = std::min((e - a + 1 + 3) & ~3, nbins);
+        int start = std::max(0, std::min(a, nbins - len));
+        first[b] = start;
+        length[b] = len;
+        offset[b] = (int)weights.size();
+        for (int k = start; k < start + len; k++)
+            weights.push_back(k >= a && k <= e ? w[k] : 0);
+    }
+} /* melFilterbank::melFilterbank */
+
+void
+melFilterbank::apply(const float* power, float* bands) const
+{
+    const int nb = size();
+    for (int b = 0; b < nb; b++) {
+        const float* p = power + first[b];
+        const float* w = &weights[offset[b]];
+        const int n = length[b];
+        float sum = 0;
+        int k = 0;
+#if defined(__SSE2__)
+        __m128 acc = _mm_setzero_ps();
+        for (; k + 4 <= n; k += 4)
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(p + k), _mm_loadu_ps(w + k)));
+        acc = _mm_add_ps(acc, _mm_shuffle_ps(acc, acc, _MM_SHUFFLE(1, 0, 3, 2)));
+        acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, _MM_SHUFFLE(2, 3, 0, 1)));
+        sum = _mm_cvtss_f32(acc);
+#endif
+        // only filters wider than the bins rounded down to 4 have a tail
+        for (; k < n; k++)
+            sum += p[k] * w[k];
+        bands[b] = sum;
+    }
+} /* melFilterbank::apply */
@@ -0,0 +1,62 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: melFilterbank.h
+ Description:
+ Triangular filterbank on the mel or Bark scale, stored sparse and
+ applied to a power spectrum.
+ */
+
+#ifndef MELFILTERBANK_H
+#define MELFILTERBANK_H
+
+#include <vector>
+
+enum filterScale {
+    SCALE_MEL = 0,      // 2595log10(1 + f/700)
+    SCALE_BARK          // Traunmüller's 26.81f/(1960 + f) - 0.53
+};
+
+// Parses "mel" or "bark", false for anything else
+bool filterScaleFromName(const char* name, filterScale& scale);
+
+class melFilterbank
+{
+public:
+    // bands filters spread evenly on the scale from 0Hz to the last of the
+    // nbins power bins, binHz apart
+    melFilterbank(int bands, int nbins, double binHz, filterScale scale = SCALE_MEL);
+
+    int size() const { return (int)first.size(); }
+    int bins() const { return nbins; }
+    // centre frequency of a band, Hz
+    float centre(int band) const { return centres[band]; }
+
+    // nbins powers in, one per band out. Each filter's weights sum to 1,
+    // so a band is the mean power under it, on the scale of the bins.
+    void apply(const float* power, float* bands) const;
+
+private:
+    int nbins;
+    std::vector<int> first;         // first bin of each filter
+    std::vector<int> length;        // weights of each filter, a multiple of 4 if it fits
+    std::vector<int> offset;        // of each filter's run in weights
+    std::vector<float> weights;     // the nonzero runs, zero padded
+    std::vector<float> centres;
+};
+
+#endif
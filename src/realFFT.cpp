@@ -0,0 +1,206 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: realFFT.cpp
+ Description:
+ Real FFT backend interface, kissfft by default, FFTW when built with
+ HAVE_FFTW.
+ */
+
+#include <vector>
+#include <algorithm>
+
+#include "realFFT.h"
+
+#if defined(HAVE_FFTW) && !defined(FIXED_POINT)
+#include <mutex>
+#include <fftw3.h>
+#define USE_FFTW
+#endif
+
+namespace {
+
+// Per thread work memory, so the transforms called from the audio
+// callback only allocate the first time a thread needs a bigger buffer.
+template <typename T, int Slot>
+T*
+threadScratch(size_t n)
+{
+    static thread_local std::vector<T> buf;
+    if (buf.size() < n)
+        buf.resize(n);
+    return &buf[0];
+}
+
+}
+
+void
+realFFT::pruned(const kiss_fft_scalar* timedata, kiss_fft_cpx* freqdata, int nbins) const
+{
+    kiss_fft_cpx* spec = threadScratch<kiss_fft_cpx, 0>(nfft / 2 + 1);
+    forward(timedata, spec);
+    std::copy(spec, spec + std::min(nbins, nfft / 2 + 1), freqdata);
+} /* realFFT::pruned */
+
+void
+realFFT::windowed(const kiss_fft_scalar* ring, int start, const kiss_fft_scalar* window,
+                  kiss_fft_cpx* freqdata, int nbins) const
+{
+    kiss_fft_scalar* frame = threadScratch<kiss_fft_scalar, 1>(nfft);
+    for (int k = 0, j = start; k < nfft; k++, j = j + 1 == nfft ? 0 : j + 1)
+#ifdef FIXED_POINT
+        frame[k] = (kiss_fft_scalar)((ring[j] * window[k] + (1 << 14)) >> 15);
+#else
+        frame[k] = ring[j] * window[k];
+#endif
+    pruned(frame, freqdata, nbins);
+} /* realFFT::windowed */
+
+void
+realFFT::batch(const kiss_fft_scalar* timedata, kiss_fft_cpx* freqdata,
+               int nframes, int in_stride, int out_stride) const
+{
+    for (int f = 0; f < nframes; f++)
+        forward(timedata + (size_t)f * in_stride, freqdata + (size_t)f * out_stride);
+} /* realFFT::batch */
+
+namespace {
+
+//
+// kissfft, every call maps onto a kiss_fftr entry point, working in the
+// calling thread's scratch
+//
+class kissRealFFT : public realFFT
+{
+public:
+    kissRealFFT(int _nfft, bool _inverse, kiss_fftr_cfg _cfg) :
+        realFFT(_nfft, _inverse), cfg(_cfg) {}
+    ~kissRealFFT() { kiss_fftr_free(cfg); }
+
+    void forward(const kiss_fft_scalar* timedata, kiss_fft_cpx* freqdata) const
+    {
+        kiss_fftr_scratch(cfg, timedata, freqdata, scratch());
+    }
+    void inverse(const kiss_fft_cpx* freqdata, kiss_fft_scalar* timedata) const
+    {
+        kiss_fftri_scratch(cfg, freqdata, timedata, scratch());
+    }
+    void pruned(const kiss_fft_scalar* timedata, kiss_fft_cpx* freqdata, int nbins) const
+    {
+        kiss_fftr_pruned_scratch(cfg, timedata, freqdata, nbins, scratch());
+    }
+    void windowed(const kiss_fft_scalar* ring, int start, const kiss_fft_scalar* window,
+                  kiss_fft_cpx* freqdata, int nbins) const
+    {
+        kiss_fftr_windowed_scratch(cfg, ring, start, window, freqdata, nbins, scratch());
+    }
+    void batch(const kiss_fft_scalar* timedata, kiss_fft_cpx* freqdata,
+               int nframes, int in_stride, int out_stride) const
+    {
+        kiss_fftr_batch_scratch(cfg, timedata, freqdata, nframes, in_stride, out_stride,
+                                scratch());
+    }
+
+private:
+    void* scratch() const { return threadScratch<char, 2>(kiss_fftr_scratch_size(cfg)); }
+
+    kiss_fftr_cfg cfg;
+};
+
+#ifdef USE_FFTW
+static_assert(sizeof(kiss_fft_scalar) == sizeof(float), "FFTW backend expects float samples");
+
+// The FFTW planner is not thread safe, plan creation and destruction
+// are serialized. Executing a plan on new arrays is.
+std::mutex fftwMutex;
+
+//
+// FFTW, single precision, unaligned so any caller buffer can be used
+//
+class fftwRealFFT : public realFFT
+{
+public:
+    fftwRealFFT(int _nfft, bool _inverse) : realFFT(_nfft, _inverse), plan(NULL)
+    {
+        std::lock_guard<std::mutex> lock(fftwMutex);
+        // FFTW_MEASURE overwrites the arrays while planning
+        float* time = fftwf_alloc_real(nfft);
+        fftwf_complex* freq = fftwf_alloc_complex(nfft / 2 + 1);
+        if (time && freq) {
+            if (inverseFFT)
+                plan = fftwf_plan_dft_c2r_1d(nfft, freq, time,
+                                             FFTW_MEASURE | FFTW_UNALIGNED | FFTW_PRESERVE_INPUT);
+            else
+                plan = fftwf_plan_dft_r2c_1d(nfft, time, freq,
+                                             FFTW_MEASURE | FFTW_UNALIGNED);
+        }
+        fftwf_free(time);
+        fftwf_free(freq);
+    }
+    ~fftwRealFFT()
+    {
+        std::lock_guard<std::mutex> lock(fftwMutex);
+        if (plan)
+            fftwf_destroy_plan(plan);
+    }
+    bool valid() const { return plan != NULL; }
+
+    // kiss_fft_cpx and fftwf_complex are both {re, im} float pairs
+    void forward(const kiss_fft_scalar* timedata, kiss_fft_cpx* freqdata) const
+    {
+        fftwf_execute_dft_r2c(plan, const_cast<float*>(timedata), (fftwf_complex*)freqdata);
+    }
+    void inverse(const kiss_fft_cpx* freqdata, kiss_fft_scalar* timedata) const
+    {
+        fftwf_execute_dft_c2r(plan, (fftwf_complex*)const_cast<kiss_fft_cpx*>(freqdata), timedata);
+    }
+
+private:
+    fftwf_plan plan;
+};
+#endif
+
+}
+
+realFFT*
+realFFT::create(int nfft, bool inverse, int backend)
+{
+    if (backend == FFT_BACKEND_FFTW) {
+#ifdef USE_FFTW
+        fftwRealFFT* fft = new fftwRealFFT(nfft, inverse);
+        if (fft->valid())
+            return fft;
+        delete fft;
+#endif
+        return NULL;
+    }
+
+    kiss_fftr_cfg cfg = kiss_fftr_alloc_flags(nfft, inverse ? 1 : 0, backend, NULL, NULL);
+    if (cfg == NULL)
+        return NULL;
+    return new kissRealFFT(nfft, inverse, cfg);
+} /* realFFT::create */
+
+bool
+realFFT::available(int backend)
+{
+#ifdef USE_FFTW
+    return true;
+#else
+    return backend != FFT_BACKEND_FFTW;
+#endif
+} /* realFFT::available */
@@ -0,0 +1,76 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: realFFT.h
+ Description:
+ Real FFT backend interface, kissfft by default, FFTW when built with
+ HAVE_FFTW.
+ */
+
+#ifndef REALFFT_H
+#define REALFFT_H
+
+// kissFFT addon include file
+#include "kiss_fft.h"
+#include "kiss_fftr.h"
+
+// Backend ids. The KISS_FFT_SIMD_* levels (with the kiss_fft_alloc_flags
+// flags) select kissfft, FFT_BACKEND_FFTW selects FFTW.
+#define FFT_BACKEND_FFTW    0x100
+
+class realFFT
+{
+public:
+    virtual ~realFFT() {}
+
+    // A new transform of nfft (even) points on the given backend, or NULL
+    // when the backend is not built in or out of memory.
+    static realFFT* create(int nfft, bool inverse, int backend);
+    // Whether the backend can be created in this build
+    static bool available(int backend);
+
+    int size() const { return nfft; }
+    bool isInverse() const { return inverseFFT; }
+
+    // nfft real samples to nfft/2+1 complex bins, forward transforms only
+    virtual void forward(const kiss_fft_scalar* timedata, kiss_fft_cpx* freqdata) const = 0;
+    // nfft/2+1 complex bins to nfft real samples, without the 1/nfft
+    // scaling, inverse transforms only
+    virtual void inverse(const kiss_fft_cpx* freqdata, kiss_fft_scalar* timedata) const = 0;
+    // Only the first nbins bins of forward
+    virtual void pruned(const kiss_fft_scalar* timedata, kiss_fft_cpx* freqdata, int nbins) const;
+    // pruned() of the nfft samples of ring from ring[start] on, wrapping
+    // around, times window (Q15 in fixed point)
+    virtual void windowed(const kiss_fft_scalar* ring, int start, const kiss_fft_scalar* window,
+                          kiss_fft_cpx* freqdata, int nbins) const;
+    // nframes forward transforms, frame f from timedata + f*in_stride to
+    // freqdata + f*out_stride
+    virtual void batch(const kiss_fft_scalar* timedata, kiss_fft_cpx* freqdata,
+                       int nframes, int in_stride, int out_stride) const;
+
+protected:
+    realFFT(int _nfft, bool _inverse) : nfft(_nfft), inverseFFT(_inverse) {}
+
+    const int nfft;
+    const bool inverseFFT;
+
+private:
+    realFFT(const realFFT&) = delete;
+    realFFT& operator=(const realFFT&) = delete;
+};
+
+#endif
@@ -0,0 +1,173 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: slidingDFT.cpp
+ Description:
+ Incremental spectrum of a sliding window, for hops much shorter than
+ the window.
+
+ Every bin of the rectangular window spectrum follows the recursion
+     S_k <- (S_k + x_new - x_old) * e^(j2pi k/N)
+ Over a hop of h samples that unrolls to
+     S_k <- S_k e^(j2pi kh/N) + sum_n d_n e^(j2pi k(h-n)/N)
+ with d_n the new minus the dropped samples. The weights are tabled per
+ hop, so a column costs h real-by-complex multiply-adds per bin, in a
+ loop over the bins the compiler vectorizes, instead of a full FFT.
+ It pays off for hops up to a few times log2(N).
+
+ The Hann window is applied afterwards in the frequency domain,
+ 0.5 S_k - 0.25 (S_k-1 + S_k+1); the Kaiser window of the FFT path has no
+ such short form, so -d runs the whole view with Hann. The accumulators
+ are double, and every resync columns they are reloaded from a full FFT
+ of the window so rounding cannot build up.
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <math.h>
+
+#include "slidingDFT.h"
+
+using namespace std;
+
+slidingDFT::slidingDFT(int _nfft, int _nbins, int _resync) :
+    nfft(_nfft), nbins(std::min(_nbins, _nfft / 2 + 1)), resync(_resync),
+    columns(0), ring(_nfft), pos(0), hop(0), frame(_nfft), spec(_nfft / 2 + 1)
+{
+    // one extra bin for the Hann kernel of the top bin
+    const int nb = nbins + 1;
+    sr.resize(nb);
+    si.resize(nb);
+    ar.resize(nb);
+    ai.resize(nb);
+
+    plan = fftPlan::get(nfft, false);
+    if (!plan) {
+        cerr << "[Error] Not enough memory!" << endl;
+        exit(-1);
+    }
+    reset();
+} /* slidingDFT::slidingDFT */
+
+void
+slidingDFT::reset()
+{
+    std::fill(ring.begin(), ring.end(), 0);
+    std::fill(sr.begin(), sr.end(), 0.);
+    std::fill(si.begin(), si.end(), 0.);
+    pos = 0;
+    columns = 0;
+} /* slidingDFT::reset */
+
+void
+slidingDFT::setHop(int _hop)
+{
+    const int nb = nbins + 1;
+    hop = _hop;
+    hr.resize(nb);
+    hi.resize(nb);
+    tr.resize((size_t)hop * nb);
+    ti.resize((size_t)hop * nb);
+    for (int k = 0; k < nb; k++) {
+        hr[k] = cos(2 * M_PI * ((long long)k * hop % nfft) / nfft);
+        hi[k] = sin(2 * M_PI * ((long long)k * hop % nfft) / nfft);
+        for (int n = 0; n < hop; n++) {
+            const double phase = 2 * M_PI * ((long long)k * (hop - n) % nfft) / nfft;
+            tr[(size_t)n * nb + k] = (float) cos(phase);
+            ti[(size_t)n * nb + k] = (float) sin(phase);
+        }
+    }
+} /* slidingDFT::setHop */
+
+void
+slidingDFT::update(const kiss_fft_scalar* samples, int _hop, kiss_fft_cpx* out)
+{
+    const int nb = nbins + 1;
+
+    if (_hop != hop)
+        setHop(_hop);
+
+    float *pa = &ar[0], *pb = &ai[0];
+    std::fill(ar.begin(), ar.end(), 0.f);
+    std::fill(ai.begin(), ai.end(), 0.f);
+    for (int n = 0; n < hop; n++) {
+        const float d = (float)samples[n] - (float)ring[pos];
+        const float *cr = &tr[(size_t)n * nb], *ci = &ti[(size_t)n * nb];
+        ring[pos] = samples[n];
+        if (++pos == nfft) pos = 0;
+
+        // independent per bin, the compiler vectorizes this loop
+        for (int k = 0; k < nb; k++) {
+            pa[k] += d * cr[k];
+            pb[k] += d * ci[k];
+        }
+    }
+
+    double *pr = &sr[0], *pi = &si[0];
+    for (int k = 0; k < nb; k++) {
+        const double r = pr[k], i = pi[k];
+        pr[k] = r * hr[k] - i * hi[k] + pa[k];
+        pi[k] = r * hi[k] + i * hr[k] + pb[k];
+    }
+
+    if (resync > 0 && ++columns >= resync)
+        resynchronize();
+
+#ifdef FIXED_POINT
+    // fixed point kiss_fftr output is scaled by 1/nfft
+    const double scale = 1.0 / nfft;
+#else
+    const double scale = 1.0;
+#endif
+    for (int k = 0; k < nbins; k++) {
+        // bin -1 is the conjugate of bin 1 for real input
+        const double lr = k ? pr[k-1] : pr[1];
+        const double li = k ? pi[k-1] : -pi[1];
+        const double r = (0.5 * pr[k] - 0.25 * (lr + pr[k+1])) * scale;
+        const double i = (0.5 * pi[k] - 0.25 * (li + pi[k+1])) * scale;
+#ifdef FIXED_POINT
+        out[k].r = (kiss_fft_scalar) std::max(-32768., std::min(32767., floor(r + 0.5)));
+        out[k].i = (kiss_fft_scalar) std::max(-32768., std::min(32767., floor(i + 0.5)));
+#else
+        out[k].r = (kiss_fft_scalar) r;
+        out[k].i = (kiss_fft_scalar) i;
+#endif
+    }
+} /* slidingDFT::update */
+
+void
+slidingDFT::resynchronize()
+{
+    // the window oldest sample first, as the recursion indexes it
+    std::copy(ring.begin() + pos, ring.end(), frame.begin());
+    std::copy(ring.begin(), ring.begin() + pos, frame.begin() + (nfft - pos));
+
+    plan->forward(&frame[0], &spec[0]);
+
+#ifdef FIXED_POINT
+    const double scale = nfft;
+#else
+    const double scale = 1.0;
+#endif
+    for (int k = 0; k <= nbins; k++) {
+        // above nfft/2 the spectrum of a real window mirrors
+        const kiss_fft_cpx c = k <= nfft / 2 ? spec[k] : spec[nfft - k];
+        sr[k] = c.r * scale;
+        si[k] = (k <= nfft / 2 ? c.i : -c.i) * scale;
+    }
+    columns = 0;
+} /* slidingDFT::resynchronize */
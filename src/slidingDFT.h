@@ -0,0 +1,75 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: slidingDFT.h
+ Description:
+ Incremental spectrum of a sliding window, for hops much shorter than
+ the window.
+ */
+
+#ifndef SLIDINGDFT_H
+#define SLIDINGDFT_H
+
+#include <vector>
+
+// kissFFT addon include file
+#include "kiss_fft.h"
+#include "kiss_fftr.h"
+#include "fftPlan.h"
+
+class slidingDFT
+{
+public:
+    // nfft: window length, nbins: number of low bins kept up to date,
+    // resync: columns between two full FFT resynchronizations.
+    slidingDFT(int nfft, int nbins, int resync = 256);
+
+    // Slide the window by hop new samples and write the nbins lowest bins
+    // of its Hann windowed spectrum to out, scaled like kiss_fftr output.
+    // Costs O(hop * nbins).
+    void update(const kiss_fft_scalar* samples, int hop, kiss_fft_cpx* out);
+
+    // Forget all samples (the window is back to silence)
+    void reset();
+
+private:
+    void setHop(int hop);
+    void resynchronize();
+
+    int nfft, nbins, resync;
+    int columns;                // columns since the last resync
+
+    // window samples, ring[pos] is the oldest
+    std::vector<kiss_fft_scalar> ring;
+    int pos;
+
+    // rectangular window spectrum of bins 0..nbins
+    std::vector<double> sr, si;
+
+    // for the current hop h: e^(j2pi k h/nfft) per bin, and the weight
+    // e^(j2pi k (h-n)/nfft) of the n-th new sample, bins innermost
+    int hop;
+    std::vector<double> hr, hi;
+    std::vector<float> tr, ti;
+    std::vector<float> ar, ai;  // spectrum of the hop's sample differences
+
+    fftr_plan plan;
+    std::vector<kiss_fft_scalar> frame; // the window in order, for the resync FFT
+    std::vector<kiss_fft_cpx> spec;
+};
+
+#endif
@@ -50,22 +50,44 @@
 // kissFFT addon include file
 #include "kiss_fft.h"
 #include "kiss_fftr.h"
+#include "fftPlan.h"
+#include "fastFIR.h"
+#include "windowContext.h"
+#include "specMap.h"
 
 // local includes
 #include "common.h"
 
+#ifdef FIXED_POINT
+#define SAMPLE_FORMAT paInt16
+// Fixed kiss_fftr output is scaled by 1/nfft and samples by 32768, so
+// 20log10 of it sits 20log10(32768/nfft) above the float spectrum; this
+// (negative) takes it back down.
+#define FIXED_DB_OFFSET (-20 * log10(32768.0 / (2 * BUFFER_LEN)))
+#else
+#define SAMPLE_FORMAT paFloat32
+#define FIXED_DB_OFFSET 0
+#endif
+
 using namespace std;
 
 typedef struct{
-    // raw sound data in float (-1.0 .. 1.0)
-    float data[BUFFER_LEN];
+    // raw sound data, float (-1.0 .. 1.0) or int16 in the fixed build
+    kiss_fft_scalar data[BUFFER_LEN];
     float volume, max_db, floor_db;
     // libsndfile handle and sfinfo
     SNDFILE* sndfile;
     SF_INFO sfinfo;
-    // kiss_fftr setup datas
-    kiss_fftr_cfg fftcfg;
+    // real FFT setup datas
+    fftr_plan fftcfg;
+    std::unique_ptr<windowContext<kiss_fft_scalar> > window;
+    // VIS_TOPFREQ bins to HEIGHT rows, built once
+    std::unique_ptr<specMap> rowMap;
+    // optional FIR pre-filter
+    std::unique_ptr<fastFIR> fir;
+    // ring of the last two buffers, the oldest sample at inPos
     kiss_fft_scalar in[BUFFER_LEN * 2];
+    int inPos;
     kiss_fft_cpx out[BUFFER_LEN * 2];
     float max_mag;
     // opencv data
@@ -97,7 +119,7 @@ int recordCallback(	const void *input,
 					void *userData)
 {
 	sndData* data = (sndData*)userData;
-	float* in = (float*)input;
+	const kiss_fft_scalar* in = (const kiss_fft_scalar*)input;
 	size_t i;
 
 	(void) output;
@@ -107,35 +129,43 @@ int recordCallback(	const void *input,
 	// fill output stream with libsndfile data
 	for(i=0; i<framePerBuffer; i++ ){
 		//*out++ = data->data[i] * data->volume;
+#ifdef FIXED_POINT
+		long v = lrintf(in[i] * data->volume);
+		data->data[i] = (kiss_fft_scalar) MAX(-32768, MIN(32767, v));
+#else
 		data->data[i] = in[i] * data->volume;
+#endif
 	}
+	// optional FIR pre-filter, the int16 block of the fixed build is
+	// convolved in float by fastFIR
+	if (data->fir)
+		data->fir->process(data->data, data->data, BUFFER_LEN);
 
 	//
 	// Do time domain windowing and FFT convertion
 	//
 	float mag [ BUFFER_LEN ] , interp_mag [ HEIGHT ];
-	kiss_fft_scalar in_win[ 2 * BUFFER_LEN];
 
-	for(i=0; i<BUFFER_LEN; i++){
-		data->in[i] = data->in[ BUFFER_LEN + i ];
-		data->in[ BUFFER_LEN + i ] = data->data[i];
-	}
+	// the new buffer replaces the oldest one
+	for(i=0; i<BUFFER_LEN; i++)
+		data->in[ data->inPos + i ] = data->data[i];
+	data->inPos = (data->inPos + BUFFER_LEN) % (2 * BUFFER_LEN);
 
-	apply_window(in_win, data->in , 2 * BUFFER_LEN);
-	kiss_fftr(data->fftcfg, in_win, data->out);
+	// only the displayed bins are needed, windowed as the FFT loads them
+	data->fftcfg->windowed(data->in, data->inPos, data->window->table(), data->out, VIS_TOPFREQ);
 
 	// 0Hz set to 0
 	mag[0] = 0;
 	//data->max_db = 0;
-	for(int i = 1; i < BUFFER_LEN; i++){
-		mag[i] = std::sqrtf(data->out[i].i * data->out[i].i +
-							data->out[i].r * data->out[i].r);
+	for(int i = 1; i < VIS_TOPFREQ; i++){
+		mag[i] = std::sqrtf((float)data->out[i].i * data->out[i].i +
+							(float)data->out[i].r * data->out[i].r);
 		// Convert to dB range 20log10(v1/v2)
-		mag[i] = 20 * log10(mag[i]);
+		mag[i] = 20 * log10(mag[i]) + FIXED_DB_OFFSET;
 		// Convert to RGB space
 		mag[i] = linestep(mag[i], data->floor_db, data->max_db) * 255;
 	}
-	interp_spec(interp_mag, HEIGHT, mag, VIS_TOPFREQ); // Draw sound spectogram
+	data->rowMap->apply(mag, interp_mag); // Draw sound spectogram
 
 	cv::line(data->specMat, cv::Point2i(data->col,0), cv::Point2i(data->col,HEIGHT), cv::Scalar(0,0,0));
 	cv::line(data->specMat, cv::Point2i(data->col+1,0), cv::Point2i(data->col+1,HEIGHT), cv::Scalar(0,0,255));
@@ -153,7 +183,7 @@ int recordCallback(	const void *input,
 void
 help(){
 	//printf("Usage: soundScore [file1.wav] [drawThreshold 0-200]\n");
-	std::cout << "Usage : soundRecord [-h] [-v volume] [-t Max_dB] [-f Floor_dB]" << endl;
+	std::cout << "Usage : soundRecord [-h] [-v volume] [-t Max_dB] [-f Floor_dB] [-b kiss|fftw] [-F taps_file] [-w window]" << endl;
 }
 
 int
@@ -177,9 +207,11 @@ main (int argc, char* argv[])
 	paUserData.max_db = 80;
 	paUserData.floor_db = -180;
 	paUserData.volume = 0.2;
+	paUserData.inPos = 0;
+	windowType window = WINDOW_KAISER;
 
 	int optionChar, prev_ind;
-	while(prev_ind = optind, (optionChar = getopt(argc,argv,"hv:t:f:"))!=EOF){
+	while(prev_ind = optind, (optionChar = getopt(argc,argv,"hv:t:f:b:F:w:"))!=EOF){
 		if(optind == prev_ind + 2 && *optarg == '-' && atoi(optarg)==0){
 			optionChar = ':';
 			-- optind;
@@ -197,6 +229,32 @@ main (int argc, char* argv[])
 				paUserData.max_db = atoi(optarg);
 				cout << "Max dB		:" << paUserData.max_db<< endl;
 				break;
+			case 'b':
+				if (strcmp(optarg, "kiss") == 0)
+					fftPlan::setBackend(KISS_FFT_SIMD_AUTO);
+				else if (strcmp(optarg, "fftw") != 0 || !fftPlan::setBackend(FFT_BACKEND_FFTW)) {
+					cerr << "FFT backend not available : " << optarg << endl;
+					return 1;
+				}
+				cout << "FFT backend	:" << optarg << endl;
+				break;
+			case 'F': {
+				std::vector<float> taps;
+				if (!fastFIR::loadTaps(optarg, taps)) {
+					cerr << "Cannot read FIR taps : " << optarg << endl;
+					return 1;
+				}
+				paUserData.fir.reset(new fastFIR(taps, BUFFER_LEN));
+				cout << "FIR taps	:" << taps.size() << endl;
+				break;
+			}
+			case 'w':
+				if (!windowTypeFromName(optarg, window)) {
+					cerr << "Unknown window : " << optarg << endl;
+					return 1;
+				}
+				cout << "Window		:" << optarg << endl;
+				break;
 			case '?':
 			case ':':
 				cerr << "Argument error !" << endl;
@@ -222,7 +280,7 @@ main (int argc, char* argv[])
 	err = Pa_OpenDefaultStream( &stream,
 								1,								// no input channels
 								0,		// output channels
-								paFloat32,						// 32 bit floating point output
+								SAMPLE_FORMAT,					// float, int16 in the fixed build
 								SAMPLERATE,						// audio sampleRate
 								BUFFER_LEN,						// frames per buffer
 								recordCallback,					// signal process callback function
@@ -243,11 +301,13 @@ main (int argc, char* argv[])
 	//
 	// Initialization of FFT
 	//
-	paUserData.fftcfg = kiss_fftr_alloc( 2 * BUFFER_LEN, 0, NULL, NULL);
-	if(paUserData.fftcfg == NULL){
+	paUserData.fftcfg = fftPlan::get( 2 * BUFFER_LEN, false);
+	if(!paUserData.fftcfg){
 		printf("Fatal: Not enough memory!\n");
 		return 1;
 	}
+	paUserData.window.reset(new windowContext<kiss_fft_scalar>(2 * BUFFER_LEN, window));
+	paUserData.rowMap.reset(new specMap(VIS_TOPFREQ, HEIGHT, SPECMAP_INTERPOLATE));
 
 	//
 	// The main loop
@@ -289,7 +349,7 @@ main (int argc, char* argv[])
 
 	/* Close input and output files. */
 	//sf_close (paUserData.sndfile) ;
-	kiss_fftr_free(paUserData.fftcfg);
+	paUserData.fftcfg.reset();
 
 	return 0 ;
 } /* main */
@@ -19,6 +19,10 @@
 
 // Standard include files
 #include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
 #include <getopt.h>
 #include <string.h>
 #include <math.h>
@@ -50,6 +54,24 @@
 // Define use visual
 #define USE_VISUAL true
 #define VIS_TOPFREQ 256
+// Constant-Q rows: 8 octaves of 32 bins from C1
+#define CQ_BINS_PER_OCTAVE 32
+#define CQ_FMIN 32.703
+
+#ifdef FIXED_POINT
+#define SAMPLE_FORMAT paInt16
+// Fixed kiss_fftr output is scaled by 1/nfft and samples by 32768, so
+// 20log10 of it sits 20log10(32768/nfft) above the float spectrum; this
+// (negative, in Q8 dB) takes it back down.
+#define FIXED_DB_OFFSET_Q8 ((int) lrint(-256 * 20 * log10(32768.0 / (2 * BUFFER_LEN))))
+// dB added to 10log10 of a bin power to put it on the float spectrum scale
+#define POWER_DB_OFFSET (FIXED_DB_OFFSET_Q8 / 256.0f)
+typedef int sample_mix;
+#else
+#define SAMPLE_FORMAT paFloat32
+#define POWER_DB_OFFSET 0.0f
+typedef float sample_mix;
+#endif
 using namespace std;
 
 void
@@ -68,25 +90,43 @@ soundView::Params::Params()
     inputDevice = USE_MIC;
     outputDevice = Pa_GetDefaultOutputDevice();
     sampleRate = 44100;
+    hopSize = BUFFER_LEN;
+    useSlidingDFT = false;
+    zoomLow = zoomHigh = 0;
+    doublePrecision = false;
+    useCepstrum = false;
+    perChannel = false;
+    window = WINDOW_KAISER;
+    rowMode = SPECMAP_INTERPOLATE;
+    perceptualRows = false;
+    bandScale = SCALE_MEL;
+    featureBands = 0;
+    useConstantQ = false;
 }; /* soundView::Params::Params() */
 
 soundView::soundView(const soundView::Params &parameters) :
     stream(0), volume(1), floor_db(0), max_db(200), col(0),
-    spectogram(cv::Size(WIDTH,HEIGHT),CV_8UC3), params(parameters)
+    spectogram(cv::Size(WIDTH,HEIGHT),CV_8UC3),
+    // pooled rows take the whole band, interpolated ones the lowest bins
+    pipeline(2 * BUFFER_LEN, parameters.rowMode == SPECMAP_INTERPOLATE ? VIS_TOPFREQ : BUFFER_LEN,
+             HEIGHT, parameters.rowMode, parameters.window),
+    sdft(2 * BUFFER_LEN, VIS_TOPFREQ),
+    featureFrames(0), featureRate(0), stereo(false), params(parameters)
 {
-
-    //
-    // Initialization of FFT
-    //
-    fftcfg = kiss_fftr_alloc( 2 * BUFFER_LEN, 0, NULL, NULL);
-    if(fftcfg == NULL){
-        cerr << "[Error] Not enough memory!" << endl;
-        exit(-1) ;
+    if (params.hopSize == 0 || BUFFER_LEN % params.hopSize != 0) {
+        cerr << "[Error] Hop size must divide " << BUFFER_LEN << endl;
+        exit(-1);
+    }
+    // its columns are Hann windowed, the FFT ones must match them
+    if (params.useSlidingDFT && params.window != WINDOW_HANN) {
+        cerr << "[Error] The sliding DFT needs the Hann window." << endl;
+        exit(-1);
     }
 
     // memory allocation of sound data
-    inputData = new float[BUFFER_LEN];
-    if (inputData == NULL) {
+    inputData = new kiss_fft_scalar[BUFFER_LEN];
+    rightData = new kiss_fft_scalar[BUFFER_LEN];
+    if (inputData == NULL || rightData == NULL) {
         cerr << "[Error] Not enough memory!" << endl;
         exit(-1);
     }
@@ -103,7 +143,127 @@ soundView::soundView(const soundView::Params &parameters) :
         if (!init_mic()) exit(-1);
     }
 
-    for(size_t i=0; i< 2*BUFFER_LEN; i++) in[i] = 0;
+    // FIR pre-filter in front of the analysis, the mic and playback
+    // callbacks get BUFFER_LEN samples at a time
+    if (!params.firTaps.empty())
+        fir.reset(new fastFIR(params.firTaps, BUFFER_LEN));
+
+    // Per channel analysis, only stereo files have a second channel
+    stereo = params.perChannel && params.inputDevice == USE_FILE && sndHandle.channels() == 2;
+    if (stereo && fir)
+        firRight.reset(new fastFIR(params.firTaps, BUFFER_LEN));
+
+    //
+    // Initialization of the zoom spectrum, the band over the spectogram rows
+    //
+    if (params.zoomHigh > params.zoomLow) {
+        double rate = params.inputDevice == USE_FILE ? sndHandle.samplerate() : params.sampleRate;
+        zoom.reset(new zoomFFT(2 * BUFFER_LEN, VIS_TOPFREQ, params.zoomLow, params.zoomHigh, rate));
+    }
+
+    static_assert(PIPELINE_FIXED_NFFT == 2 * BUFFER_LEN, "-D frames should take kissfft_fixed");
+    if (params.doublePrecision)
+        validation.reset(new spectrumPipeline<double>(2 * BUFFER_LEN, VIS_TOPFREQ, HEIGHT,
+                                                      params.rowMode, params.window));
+
+    //
+    // Initialization of the Goertzel bank, replacing the spectogram
+    //
+    if (!params.toneFreqs.empty()) {
+        featureRate = params.inputDevice == USE_FILE ? sndHandle.samplerate() : params.sampleRate;
+        tones.reset(new goertzelBank(params.toneFreqs, featureRate, 2 * BUFFER_LEN, params.window));
+        toneLevels.resize(params.toneFreqs.size());
+
+        std::ostringstream line;
+        line << "[Tone] time(s)";
+        for (size_t k = 0; k < params.toneFreqs.size(); k++)
+            line << " " << params.toneFreqs[k] << "Hz";
+        cout << line.str() << endl;
+    }
+
+    //
+    // Initialization of the cepstrum, computed from the drawn spectrum
+    //
+    if (params.useCepstrum) {
+        if (tones || zoom || validation) {
+            cerr << "[Error] Cepstrum needs the FFT spectogram, not a tone, zoom or double run." << endl;
+            exit(-1);
+        }
+        featureRate = params.inputDevice == USE_FILE ? sndHandle.samplerate() : params.sampleRate;
+        ceps.reset(new cepstrum(2 * BUFFER_LEN, featureRate));
+
+        std::ostringstream line;
+        line << "[Cepstrum] time(s) pitch(Hz)";
+        for (int k = 0; k < ceps->size(); k++)
+            line << " c" << k;
+        cout << line.str() << endl;
+    }
+
+    //
+    // Initialization of the mel/Bark filterbanks over the drawn bins
+    //
+    if (params.perceptualRows || params.featureBands > 0) {
+        if (tones || zoom || validation) {
+            cerr << "[Error] Mel/Bark bands need the FFT spectogram, not a tone, zoom or double run." << endl;
+            exit(-1);
+        }
+        double rate = params.inputDevice == USE_FILE ? sndHandle.samplerate() : params.sampleRate;
+        double binHz = rate / (2 * BUFFER_LEN);
+        if (params.perceptualRows) {
+            rowBank.reset(new melFilterbank(VIS_TOPFREQ, VIS_TOPFREQ, binHz, params.bandScale));
+            pipeline.setBank(rowBank.get());
+        }
+        if (params.featureBands > 0) {
+            if (ceps) {
+                cerr << "[Error] Print either the cepstrum or the bands, not both." << endl;
+                exit(-1);
+            }
+            featureRate = rate;
+            featureBank.reset(new melFilterbank(params.featureBands, VIS_TOPFREQ, binHz, params.bandScale));
+            bandPowers.resize(params.featureBands);
+
+            std::ostringstream line;
+            line << "[Band] time(s)" << std::fixed << std::setprecision(0);
+            for (int k = 0; k < featureBank->size(); k++)
+                line << " " << featureBank->centre(k) << "Hz";
+            cout << line.str() << endl;
+        }
+    }
+
+    //
+    // Initialization of the constant-Q transform, replacing the FFT columns
+    //
+    if (params.useConstantQ) {
+        if (tones || zoom || validation || ceps || rowBank || featureBank) {
+            cerr << "[Error] The constant-Q spectogram takes no tone, zoom, double, cepstrum or band run." << endl;
+            exit(-1);
+        }
+        double rate = params.inputDevice == USE_FILE ? sndHandle.samplerate() : params.sampleRate;
+        // same level for a sinusoid as in the windowed FFT columns
+        double gain = 0;
+        const windowContext<kiss_fft_scalar>& window = pipeline.windowing();
+        for (int n = 0; n < window.size(); n++)
+            gain += window.table()[n];
+#ifdef FIXED_POINT
+        gain /= 32768;
+#endif
+        cqt.reset(new constantQ(2 * BUFFER_LEN, VIS_TOPFREQ, CQ_BINS_PER_OCTAVE, CQ_FMIN, rate, gain));
+    }
+
+    if (pipeline.bins() != VIS_TOPFREQ &&
+        (tones || zoom || validation || rowBank || cqt || params.useSlidingDFT)) {
+        cerr << "[Error] Average/max rows pool the FFT spectogram, not a tone, zoom, double, mel/Bark, constant-Q or sliding DFT run." << endl;
+        exit(-1);
+    }
+
+    if (stereo && (tones || zoom || validation || ceps || featureBank || cqt)) {
+        cerr << "[Error] Per channel analysis only draws the FFT spectogram." << endl;
+        exit(-1);
+    }
+
+    for(size_t i=0; i< 2*BUFFER_LEN; i++) in[i] = inRight[i] = 0;
+    inPos = 0;
+    setLevels(volume, max_db, floor_db);
 
     //spectogram= cv::Mat(cv::Size(WIDTH, HEIGHT),CV_8UC3);
 
@@ -181,32 +341,7 @@ soundView::start()
         else
         {
             // If no output needed, read file and generate spectogram directly
-            while(true) {
-                //unsigned int chn = sndHandle.channels();
-                sf_count_t readCount;
-                if(chn > 1)
-                {
-                    // if channel > 1, mix down to mono audio data first
-                    float *multiChannelData = new float[BUFFER_LEN * chn];
-                    readCount = sndHandle.read(multiChannelData, BUFFER_LEN * chn);
-
-                    for (size_t i=0; i<BUFFER_LEN; i++) {
-                        float mix = 0;
-                        for(size_t j = 0; j < chn; j++)
-                            mix += multiChannelData[ i * chn + j ];
-                        *inputData++ = mix/chn;
-                    }
-                    readCount = readCount/chn;
-                }
-                else
-                    readCount = sndHandle.read(inputData, BUFFER_LEN);
-
-                drawBuffer(inputData);
-
-                // end loop while reaching end of file
-                if((readCount) < BUFFER_LEN) break;
-
-            }
+            drawFile();
         }
     }
     return true;
@@ -229,6 +364,12 @@ soundView::setLevels(const float _volume, const float _max_db, const float _floo
     volume = _volume;
     max_db = _max_db;
     floor_db = _floor_db;
+#ifdef FIXED_POINT
+    volume_q12 = (int) lrintf(volume * 4096);
+#endif
+    pipeline.setRange(floor_db, max_db, POWER_DB_OFFSET);
+    if (validation)
+        validation->setRange(floor_db, max_db);
 } /* soundView::setLevels */
 
 bool
@@ -297,7 +438,7 @@ soundView::init_file()
         if(outputParams.device != paNoDevice){
 
             outputParams.channelCount = sndHandle.channels();
-            outputParams.sampleFormat = paFloat32;
+            outputParams.sampleFormat = SAMPLE_FORMAT;
             outputParams.suggestedLatency = Pa_GetDeviceInfo(outputParams.device)->defaultLowInputLatency;
             outputParams.hostApiSpecificStreamInfo = NULL;
         }
@@ -316,7 +457,7 @@ soundView::init_mic()
         std::cerr << "[Error] Failed to open audio input device: " << inputParams.device << endl;
         return false;
     }
-    inputParams.sampleFormat = paFloat32;
+    inputParams.sampleFormat = SAMPLE_FORMAT;
     inputParams.suggestedLatency = Pa_GetDeviceInfo(inputParams.device)->defaultLowInputLatency;
     inputParams.hostApiSpecificStreamInfo = NULL;
 
@@ -347,7 +488,7 @@ soundView::RecordCallbackImpl(  const void *input,
                     const PaStreamCallbackTimeInfo *timeInfo,
                     PaStreamCallbackFlags statusFlags)
 {
-    const float* rptr = (const float*)input;
+    const kiss_fft_scalar* rptr = (const kiss_fft_scalar*)input;
     size_t i;
 
     (void) output;
@@ -356,7 +497,7 @@ soundView::RecordCallbackImpl(  const void *input,
 
     // fill output stream with libsndfile data
     for(i=0; i<framePerBuffer; i++ ){
-        inputData[i] = rptr[i] * volume; // multiply by volume setting
+        inputData[i] = scaled(rptr[i]); // multiply by volume setting
         //inputData++, rptr++;
     }
     drawBuffer(inputData);
@@ -382,7 +523,7 @@ soundView::playCallbackImpl(const void *input,
                     const PaStreamCallbackTimeInfo *timeInfo,
                     PaStreamCallbackFlags statusFlags)
 {
-    float* wptr = (float*)output;
+    kiss_fft_scalar* wptr = (kiss_fft_scalar*)output;
     size_t i;
     sf_count_t readCount;
 
@@ -393,17 +534,30 @@ soundView::playCallbackImpl(const void *input,
     // If it's dual channel audio, double the read buffer
     // And downsample to mono data
     unsigned int chn = sndHandle.channels();
-    if (chn > 1)
+    if (stereo)
+    {
+        // keep the channels apart, both are analysed
+        std::vector<kiss_fft_scalar> steroData(framePerBuffer);
+        readCount = sndHandle.read(&steroData[0], framePerBuffer);
+        for (i=0; i<framePerBuffer/chn; i++)
+        {
+            inputData[i] = steroData[ i * chn ];
+            rightData[i] = steroData[ i * chn + 1 ];
+            *wptr++ = scaled(inputData[i]);
+            *wptr++ = scaled(rightData[i]);
+        }
+    }
+    else if (chn > 1)
     {
-        float* steroData = new float[framePerBuffer];
-        readCount = sndHandle.read(steroData, framePerBuffer);
+        std::vector<kiss_fft_scalar> steroData(framePerBuffer);
+        readCount = sndHandle.read(&steroData[0], framePerBuffer);
         for (i=0; i<framePerBuffer/chn; i++)
         {
-            float mix = 0;
+            sample_mix mix = 0;
             for(size_t j = 0; j < chn; j++)
             {
                 mix += steroData[ i * chn + j ];
-                *wptr++ = steroData[i * chn +j ] * volume;
+                *wptr++ = scaled(steroData[i * chn +j ]);
             }
             inputData[i] = mix/chn;
         }
@@ -413,9 +567,9 @@ soundView::playCallbackImpl(const void *input,
     else{
         readCount = sndHandle.read(inputData, framePerBuffer);
         for(i=0; i<framePerBuffer; i++)
-            *wptr++ = inputData[i] * volume;
+            *wptr++ = scaled(inputData[i]);
     }
-    drawBuffer(inputData);
+    drawBuffer(inputData, stereo ? rightData : NULL);
 
 
     // Read sndfile in, check if the file reach the end?
@@ -432,96 +586,309 @@ soundView::playCallbackImpl(const void *input,
 } /* soundView::playbackImpl */
 
 void
-soundView::drawBuffer(const void* input)
+soundView::drawBuffer(const void* input, const void* right)
 {
 
-    const float* data = (const float*)input;
+    const kiss_fft_scalar* data = (const kiss_fft_scalar*)input;
+    const kiss_fft_scalar* rdata = (const kiss_fft_scalar*)right;
+    const size_t hop = params.hopSize;
     size_t i;
+
+    kiss_fft_scalar filtered[ BUFFER_LEN ], rfiltered[ BUFFER_LEN ];
+    if (fir) {
+        fir->process(data, filtered, BUFFER_LEN);
+        data = filtered;
+    }
+    if (rdata && firRight) {
+        firRight->process(rdata, rfiltered, BUFFER_LEN);
+        rdata = rfiltered;
+    }
+
     //
-    // Do time domain windowing and FFT convertion
+    // Do time domain windowing and FFT convertion, one column per hop.
+    // in (and inRight) are rings of the last 2 * BUFFER_LEN samples, the
+    // oldest at inPos.
     //
-    float mag [ BUFFER_LEN ] , interp_mag [ HEIGHT ];
-    kiss_fft_scalar in_win[ 2 * BUFFER_LEN];
+    const size_t nfft = 2 * BUFFER_LEN;
+    kiss_fft_scalar frame[ 2 * BUFFER_LEN], in_win[ 2 * BUFFER_LEN];
+
+    for (size_t h = 0; h < BUFFER_LEN; h += hop) {
+        if (cqt) {
+            // log spaced column, the octaves keep their own frames
+            cqt->process(data + h, (int)hop, out);
+            drawSpectrum(out);
+            continue;
+        }
+        if (params.useSlidingDFT && !rdata && !tones && !zoom && !validation && !ceps) {
+            sdft.update(data + h, (int)hop, out);
+            drawSpectrum(out);
+            continue;
+        }
 
-    for(i=0; i<BUFFER_LEN; i++){
-        in[i] = in[ BUFFER_LEN + i ];
-        in[ BUFFER_LEN + i ] = data[i];
-    }
+        for(i=0; i<hop; i++) {
+            in[inPos] = data[h + i];
+            if (rdata)
+                inRight[inPos] = rdata[h + i];
+            if (++inPos == nfft)
+                inPos = 0;
+        }
 
-    apply_window(in_win, in , 2 * BUFFER_LEN);
-    kiss_fftr(fftcfg, in_win, out);
-
-    // 0Hz set to 0
-    mag[0] = 0;
-    float max_mag = 0;
-    for(int i = 1; i < BUFFER_LEN; i++){
-        mag[i] = std::sqrtf(out[i].i * out[i].i +
-                            out[i].r * out[i].r);
-        // Convert to dB range 20log10(v1/v2)
-        mag[i] = 20 * log10(mag[i]);
-        // Convert to RGB space
-        mag[i] = linestep(mag[i], floor_db, max_db) * 255;
-        max_mag = std::max(max_mag, mag[i]);
-    }
-    if (max_mag > 0 && col < WIDTH) {
-        interp_spec(interp_mag, HEIGHT, mag, VIS_TOPFREQ); // Draw sound spectogram
+        if (!tones && !validation && !zoom && !ceps) {
+            // only the displayed bins are needed, straight from the ring
+            pipeline.spectrum(in, inPos, out);
+            if (rdata) {
+                // one column from both channels
+                kiss_fft_cpx rout[ BUFFER_LEN ];
+                pipeline.spectrum(inRight, inPos, rout);
+                drawSpectrum(out, rout);
+            } else
+                drawSpectrum(out);
+            continue;
+        }
 
-        cv::line(spectogram, cv::Point2i(col,0), cv::Point2i(col,HEIGHT), cv::Scalar(0,0,0));
-        cv::line(spectogram, cv::Point2i(col+1,0), cv::Point2i(col+1,HEIGHT), cv::Scalar(0,0,255));
-        for(int row = 0; row < HEIGHT; row++){
-            spectogram.at<cv::Vec3b>(row, col)
-                = cv::Vec3b(    interp_mag[row],
-                                interp_mag[row],
-                                interp_mag[row]);
+        // the other analyses take the frame in order
+        std::copy(in + inPos, in + nfft, frame);
+        std::copy(in, in + inPos, frame + nfft - inPos);
+
+        if (tones) {
+            // only the requested frequencies, no spectrum
+            drawTones(frame);
+        } else if (validation) {
+            drawValidation(frame);
+        } else {
+            if (zoom) {
+                pipeline.windowing().apply(in_win, frame);
+                zoom->transform(in_win, out);
+            } else {
+                // the cepstrum needs every bin
+                pipeline.spectra(frame, (int)nfft, 1, out);
+                drawCepstrum(out);
+            }
+            drawSpectrum(out);
         }
-        // col = (col+1) % WIDTH;
-        col++;
     }
 } /* soundView::drawBuffer */
 
 void
-soundView::drawRawBuffer(const void* input)
+soundView::drawFile()
 {
+    // Hops read per round, the pipeline batches their frames for the FFT
+    const size_t batch = 64;
+    const int nfft = 2 * BUFFER_LEN;
+    const int nbins = BUFFER_LEN + 1;
+    const size_t hop = params.hopSize;
+    const size_t history = nfft - hop;
+    unsigned int chn = sndHandle.channels();
 
-    const float* data = (const float*)input;
-    size_t i;
-    //
-    // Do time domain windowing and FFT convertion
-    //
-    float mag [ BUFFER_LEN ];
+    // Mono audio of one batch, preceded by the last nfft - hop samples of
+    // the previous batch (silence for the first one, as drawBuffer sees it).
+    std::vector<kiss_fft_scalar> mono(history + batch * hop, 0);
+    std::vector<kiss_fft_scalar> chnData(hop * chn);
+    // In per channel mode mono holds the left channel and right the right
+    // one, the right spectra are kept after the left ones.
+    const size_t nchn = stereo ? 2 : 1;
+    std::vector<kiss_fft_scalar> right(stereo ? history + batch * hop : 0, 0);
+    // windowed frames of the zoom spectrum
+    std::vector<kiss_fft_scalar> frames(zoom ? batch * nfft : 0);
+    std::vector<kiss_fft_cpx> spec(nchn * batch * nbins);
+    bool eof = false;
+
+    while (!eof) {
+        // Read hops until the batch is full. Like the block by block loop,
+        // the final partial (possibly empty) hop still makes a column.
+        size_t n = 0;
+        while (n < batch && !eof) {
+            sf_count_t readCount = sndHandle.read(&chnData[0], hop * chn) / chn;
+            kiss_fft_scalar *dst = &mono[history + n * hop];
+            if (stereo) {
+                kiss_fft_scalar *rdst = &right[history + n * hop];
+                for (sf_count_t i = 0; i < (sf_count_t)hop; i++) {
+                    dst[i] = i < readCount ? chnData[ i * 2 ] : 0;
+                    rdst[i] = i < readCount ? chnData[ i * 2 + 1 ] : 0;
+                }
+                if (fir) {
+                    fir->process(dst, dst, (int)hop);
+                    firRight->process(rdst, rdst, (int)hop);
+                }
+                eof = readCount < (sf_count_t)hop;
+                n++;
+                continue;
+            }
+            for (sf_count_t i = 0; i < (sf_count_t)hop; i++) {
+                // if channel > 1, mix down to mono audio data first
+                sample_mix mix = 0;
+                if (i < readCount)
+                    for (size_t j = 0; j < chn; j++)
+                        mix += chnData[ i * chn + j ];
+                dst[i] = mix/chn;
+            }
+            if (fir)
+                fir->process(dst, dst, (int)hop);
+            eof = readCount < (sf_count_t)hop;
+            n++;
+        }
 
-    for(i=0; i<BUFFER_LEN; i++){
-        in[i] = in[ BUFFER_LEN + i ];
-        in[ BUFFER_LEN + i ] = data[i];
-    }
+        if (tones || validation) {
+            for (size_t f = 0; f < n; f++) {
+                if (tones)
+                    drawTones(&mono[f * hop]);
+                else
+                    drawValidation(&mono[f * hop]);
+            }
+            std::copy(mono.begin() + n * hop, mono.begin() + n * hop + history, mono.begin());
+            continue;
+        }
+
+        if (stereo) {
+            pipeline.spectra(&mono[0], (int)hop, (int)n, &spec[0]);
+            pipeline.spectra(&right[0], (int)hop, (int)n, &spec[n * nbins]);
+            for (size_t f = 0; f < n; f++)
+                drawSpectrum(&spec[f * nbins], &spec[(n + f) * nbins]);
 
-    kiss_fftr(fftcfg, in, out);
-
-    // 0Hz set to 0
-    mag[0] = 0;
-    float max_mag = 0;
-    for(int i = 1; i < BUFFER_LEN; i++){
-        mag[i] = std::sqrtf(out[i].i * out[i].i +
-                            out[i].r * out[i].r);
-        // Convert to dB range 20log10(v1/v2)
-        mag[i] = 20 * log10(mag[i]);
-        // Convert to RGB space
-        mag[i] = linestep(mag[i], floor_db, max_db) * 255;
-        max_mag = std::max(max_mag, mag[i]);
+            std::copy(mono.begin() + n * hop, mono.begin() + n * hop + history, mono.begin());
+            std::copy(right.begin() + n * hop, right.begin() + n * hop + history, right.begin());
+            continue;
+        }
+
+        if (cqt) {
+            for (size_t f = 0; f < n; f++)
+                cqt->process(&mono[history + f * hop], (int)hop, &spec[f * nbins]);
+        } else if (params.useSlidingDFT && !zoom && !ceps) {
+            for (size_t f = 0; f < n; f++)
+                sdft.update(&mono[history + f * hop], (int)hop, &spec[f * nbins]);
+        } else if (zoom) {
+            for (size_t f = 0; f < n; f++) {
+                pipeline.windowing().apply(&frames[f * nfft], &mono[f * hop]);
+                zoom->transform(&frames[f * nfft], &spec[f * nbins]);
+            }
+        } else {
+            pipeline.spectra(&mono[0], (int)hop, (int)n, &spec[0]);
+        }
+        for (size_t f = 0; f < n; f++) {
+            if (ceps)
+                drawCepstrum(&spec[f * nbins]);
+            drawSpectrum(&spec[f * nbins]);
+        }
+
+        std::copy(mono.begin() + n * hop, mono.begin() + n * hop + history, mono.begin());
     }
-    if (max_mag > 0) {
+} /* soundView::drawFile */
+
+void
+soundView::drawSpectrum(const kiss_fft_cpx* spec, const kiss_fft_cpx* right)
+{
+    float rows [ HEIGHT ], rrows [ HEIGHT ];
+    if (featureBank)
+        drawBands(spec);
+    // power, levels and rows of the drawn bins, in the pipeline
+    float max_level = pipeline.rows(spec, rows);
+    if (right)
+        max_level = std::max(max_level, pipeline.rows(right, rrows));
+    drawRows(rows, max_level, right ? rrows : NULL);
+} /* soundView::drawSpectrum */
+
+void
+soundView::drawRows(const float* rows, float max_level, const float* right)
+{
+    if (max_level > 0 && col < WIDTH) {
+        // left channel in red, right in green and blue: centred sound stays grey
+        if (!right)
+            right = rows;
 
         cv::line(spectogram, cv::Point2i(col,0), cv::Point2i(col,HEIGHT), cv::Scalar(0,0,0));
         cv::line(spectogram, cv::Point2i(col+1,0), cv::Point2i(col+1,HEIGHT), cv::Scalar(0,0,255));
         for(int row = 0; row < HEIGHT; row++){
             spectogram.at<cv::Vec3b>(row, col)
-                = cv::Vec3b(    mag[row],
-                                mag[row],
-                                mag[row]);
+                = cv::Vec3b(    right[row],
+                                right[row],
+                                rows[row]);
         }
-        col = (col+1) % WIDTH;
+        // col = (col+1) % WIDTH;
+        col++;
     }
-} /* soundView::drawBuffer */
+} /* soundView::drawRows */
+
+void
+soundView::drawValidation(const kiss_fft_scalar* frame)
+{
+    double frame_d [ 2 * BUFFER_LEN ];
+    float rows [ HEIGHT ];
+
+    for (int n = 0; n < 2 * BUFFER_LEN; n++)
+#ifdef FIXED_POINT
+        frame_d[n] = frame[n] / 32768.0;
+#else
+        frame_d[n] = frame[n];
+#endif
+
+    // the same stages in double, from the window to the rows
+    float max_level = validation->process(frame_d, rows);
+    drawRows(rows, max_level);
+} /* soundView::drawValidation */
+
+kiss_fft_scalar
+soundView::scaled(kiss_fft_scalar sample) const
+{
+#ifdef FIXED_POINT
+    int v = (sample * volume_q12 + (1 << 11)) >> 12;
+    return (kiss_fft_scalar) MAX(-32768, MIN(32767, v));
+#else
+    return sample * volume;
+#endif
+} /* soundView::scaled */
+
+void
+soundView::drawTones(const kiss_fft_scalar* frame)
+{
+    tones->process(frame, &toneLevels[0]);
+
+    // one line per frame: time of the frame end, then the levels in dB
+    std::ostringstream line;
+    line << "[Tone] " << std::fixed << std::setprecision(3)
+         << (double)(featureFrames + 1) * params.hopSize / featureRate;
+    line << std::setprecision(1);
+    for (size_t k = 0; k < toneLevels.size(); k++)
+        line << " " << toneLevels[k];
+    cout << line.str() << endl;
+    featureFrames++;
+} /* soundView::drawTones */
+
+void
+soundView::drawCepstrum(const kiss_fft_cpx* spec)
+{
+    ceps->process(spec);
+
+    // one line per frame: time of the frame end, pitch, then c0..cN
+    std::ostringstream line;
+    line << "[Cepstrum] " << std::fixed << std::setprecision(3)
+         << (double)(featureFrames + 1) * params.hopSize / featureRate;
+    line << std::setprecision(1) << " " << ceps->pitch() << std::setprecision(4);
+    for (int k = 0; k < ceps->size(); k++)
+        line << " " << ceps->coefficients()[k];
+    cout << line.str() << endl;
+    featureFrames++;
+} /* soundView::drawCepstrum */
+
+void
+soundView::drawBands(const kiss_fft_cpx* spec)
+{
+    float power [ VIS_TOPFREQ ];
+    power[0] = 0;
+    for (int i = 1; i < VIS_TOPFREQ; i++)
+        power[i] = spectrumPipeline<kiss_fft_scalar>::power(spec[i]);
+    featureBank->apply(power, &bandPowers[0]);
+
+    // one line per frame: time of the frame end, then the band levels in
+    // dB on the float spectrum scale
+    std::ostringstream line;
+    line << "[Band] " << std::fixed << std::setprecision(3)
+         << (double)(featureFrames + 1) * params.hopSize / featureRate;
+    line << std::setprecision(1);
+    for (size_t k = 0; k < bandPowers.size(); k++)
+        line << " " << 10 * log10f(bandPowers[k]) + POWER_DB_OFFSET;
+    cout << line.str() << endl;
+    featureFrames++;
+} /* soundView::drawBands */
 
 
 
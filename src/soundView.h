@@ -19,6 +19,8 @@
 
 // Standard include files
 #include <iostream>
+#include <vector>
+#include <memory>
 #include <getopt.h>
 #include <string.h>
 #include <math.h>
@@ -37,10 +39,28 @@
 // kissFFT addon include file
 #include "kiss_fft.h"
 #include "kiss_fftr.h"
+#include "fftPlan.h"
+#include "slidingDFT.h"
+#include "goertzelBank.h"
+#include "zoomFFT.h"
+#include "spectrumPipeline.h"
+#include "fastFIR.h"
+#include "cepstrum.h"
+#include "windowContext.h"
+#include "specMap.h"
+#include "melFilterbank.h"
+#include "constantQ.h"
 
 // Define buffer length to hold the sound data
 #define BUFFER_LEN 512
 
+// Building with FIXED_POINT=16 switches the whole analysis path to int16:
+// samples are read as short, windowed in Q15 and transformed by the fixed
+// point kiss_fftr. kiss_fft_scalar is the sample type in both builds.
+#if defined(FIXED_POINT) && FIXED_POINT != 16
+#error "soundView only supports FIXED_POINT=16"
+#endif
+
 enum SNDV_PARAM {
     USE_MIC = 0,
     USE_FILE = 1
@@ -55,6 +75,20 @@ public:
 		PaDeviceIndex outputDevice;
         char* inputFilename;
         double sampleRate;
+        unsigned int hopSize;   // samples between columns, divides BUFFER_LEN
+        bool useSlidingDFT;     // update the spectrum incrementally per hop
+        std::vector<float> toneFreqs;   // if set, only print these levels (Hz)
+        double zoomLow, zoomHigh;       // if set, draw only this band (Hz)
+        bool doublePrecision;   // whole analysis in double, for validation
+        std::vector<float> firTaps;     // if set, filter the input first
+        bool useCepstrum;       // print cepstral features per column
+        bool perChannel;        // stereo files: left in red, right in cyan
+        windowType window;      // analysis window of every frame
+        specMapMode rowMode;    // how spectrum bins are mapped to image rows
+        bool perceptualRows;    // draw the rows on bandScale instead of linear
+        filterScale bandScale;  // mel or Bark, for the rows and the bands
+        int featureBands;       // if set, print this many band levels per column
+        bool useConstantQ;      // draw constant-Q columns instead of the FFT
     };
     
     soundView(const soundView::Params &parameters = soundView::Params());
@@ -111,8 +145,15 @@ private:
         const PaStreamCallbackTimeInfo *timeInfo,
         PaStreamCallbackFlags statusFlags );
     
-    void drawBuffer(const void* input);
-    void drawRawBuffer(const void* input);
+    void drawBuffer(const void* input, const void* right = NULL);
+    void drawFile();
+    void drawSpectrum(const kiss_fft_cpx* spec, const kiss_fft_cpx* right = NULL);
+    void drawRows(const float* rows, float max_level, const float* right = NULL);
+    void drawValidation(const kiss_fft_scalar* frame);
+    void drawTones(const kiss_fft_scalar* frame);
+    void drawCepstrum(const kiss_fft_cpx* spec);
+    void drawBands(const kiss_fft_cpx* spec);
+    kiss_fft_scalar scaled(kiss_fft_scalar sample) const;
     
 	// portaudio variables
     PaStream *stream;
@@ -123,16 +164,37 @@ private:
     unsigned int col;       // current columne in Mat drawing
 
     // kiss_fft data
-    kiss_fft_scalar in[BUFFER_LEN*2];
+    kiss_fft_scalar in[BUFFER_LEN*2];       // ring of the latest samples
+    kiss_fft_scalar inRight[BUFFER_LEN*2];  // right channel ring, per channel mode
+    unsigned int inPos;                     // oldest sample in both rings
     kiss_fft_cpx out[BUFFER_LEN*2];
-    kiss_fftr_cfg fftcfg;
+    // window -> FFT -> power -> levels -> rows of the drawn columns,
+    // VIS_TOPFREQ bins, or BUFFER_LEN when the rows pool them
+    spectrumPipeline<kiss_fft_scalar> pipeline;
+    slidingDFT sdft;
+    std::unique_ptr<fastFIR> fir, firRight;
+    std::unique_ptr<zoomFFT> zoom;
+    std::unique_ptr<spectrumPipeline<double> > validation;
+    std::unique_ptr<goertzelBank> tones;
+    std::unique_ptr<cepstrum> ceps;
+    std::unique_ptr<melFilterbank> rowBank, featureBank;
+    std::unique_ptr<constantQ> cqt;
+    std::vector<float> bandPowers;
+    std::vector<float> toneLevels;
+    unsigned long featureFrames;    // frames printed by drawTones/drawCepstrum/drawBands
+    double featureRate;
 
     // libsndfile data
     SndfileHandle sndHandle;
 
     // sound core data
-    float *inputData;
+    kiss_fft_scalar *inputData;
+    kiss_fft_scalar *rightData;
+    bool stereo;            // analysing both channels of a stereo file
     float volume, floor_db, max_db;
+#ifdef FIXED_POINT
+    int volume_q12;         // volume in Q12
+#endif
 
     Params params;
 };
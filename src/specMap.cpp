@@ -0,0 +1,113 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: specMap.cpp
+ Description:
+ Precomputed mapping of spectrum bins to image rows, by interpolation,
+ averaging or max-pooling.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <algorithm>
+
+#include "specMap.h"
+
+using namespace std;
+
+bool
+specMapModeFromName(const char* name, specMapMode& mode)
+{
+    if (strcmp(name, "interpolate") == 0)
+        mode = SPECMAP_INTERPOLATE;
+    else if (strcmp(name, "average") == 0)
+        mode = SPECMAP_AVERAGE;
+    else if (strcmp(name, "max") == 0)
+        mode = SPECMAP_MAX;
+    else
+        return false;
+    return true;
+} /* specMapModeFromName */
+
+specMap::specMap(int _speclen, int _maglen, specMapMode mode) :
+    speclen(_speclen), maglen(_maglen), type(mode),
+    first(_maglen), count(_maglen), weight(_maglen)
+{
+    if (speclen < 2 || maglen < 2) {
+        cerr << "[Error] Spectrum map needs at least 2 bins and 2 rows" << endl;
+        exit(-1);
+    }
+
+    // bins per row, row i is centred on bin i * scale
+    const double scale = (double)(speclen - 1) / (maglen - 1);
+    pooled = mode != SPECMAP_INTERPOLATE && scale > 1;
+
+    for (int i = 0; i < maglen; i++) {
+        double x = i * scale;
+        if (pooled) {
+            // the bins in [x - scale/2, x + scale/2), at least one as scale > 1
+            int a = std::max(0, (int)ceil(x - scale / 2));
+            int b = std::min(speclen, (int)ceil(x + scale / 2));
+            first[i] = a;
+            count[i] = b - a;
+            weight[i] = 1.0f / count[i];
+        } else {
+            // the last row lands on the last bin with full weight
+            int lo = std::min((int)floor(x), speclen - 2);
+            first[i] = lo;
+            count[i] = 2;
+            weight[i] = (float)(x - lo);
+        }
+    }
+} /* specMap::specMap */
+
+void
+specMap::apply(const float* spec, float* mag) const
+{
+    if (speclen == maglen) {
+        std::copy(spec, spec + speclen, mag);
+        return;
+    }
+
+    const int* f = &first[0];
+    const int* n = &count[0];
+    const float* w = &weight[0];
+    if (!pooled) {
+        for (int i = 0; i < maglen; i++) {
+            const float* p = spec + f[i];
+            mag[i] = p[0] + (p[1] - p[0]) * w[i];
+        }
+    } else if (type == SPECMAP_MAX) {
+        for (int i = 0; i < maglen; i++) {
+            const float* p = spec + f[i];
+            float m = p[0];
+            for (int k = 1; k < n[i]; k++)
+                m = std::max(m, p[k]);
+            mag[i] = m;
+        }
+    } else {
+        for (int i = 0; i < maglen; i++) {
+            const float* p = spec + f[i];
+            float sum = 0;
+            for (int k = 0; k < n[i]; k++)
+                sum += p[k];
+            mag[i] = sum * w[i];
+        }
+    }
+} /* specMap::apply */
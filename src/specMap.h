@@ -0,0 +1,62 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: specMap.h
+ Description:
+ Precomputed mapping of spectrum bins to image rows, by interpolation,
+ averaging or max-pooling.
+ */
+
+#ifndef SPECMAP_H
+#define SPECMAP_H
+
+#include <vector>
+
+enum specMapMode {
+    SPECMAP_INTERPOLATE = 0,    // linear between the two nearest bins
+    SPECMAP_AVERAGE,            // mean of the bins under a row
+    SPECMAP_MAX                 // loudest bin under a row, keeps narrow peaks
+};
+
+// Parses "interpolate", "average" or "max", false for anything else
+bool specMapModeFromName(const char* name, specMapMode& mode);
+
+class specMap
+{
+public:
+    // Maps speclen bins onto maglen rows, bin 0 to row 0 and the last bin
+    // to the last row. Averaging and max-pooling need more bins than rows,
+    // with fewer they interpolate.
+    specMap(int speclen, int maglen, specMapMode mode = SPECMAP_INTERPOLATE);
+
+    int bins() const { return speclen; }
+    int rows() const { return maglen; }
+    specMapMode mode() const { return type; }
+
+    // spec holds speclen values, mag receives maglen
+    void apply(const float* spec, float* mag) const;
+
+private:
+    int speclen, maglen;
+    specMapMode type;
+    bool pooled;                // rows pool several bins, else interpolate
+    std::vector<int> first;     // first bin of each row
+    std::vector<int> count;     // bins pooled into each row
+    std::vector<float> weight;  // interpolation weight of the next bin, or 1/count
+};
+
+#endif
@@ -0,0 +1,117 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: spectrumPipeline.cpp
+ Description:
+ Spectogram analysis chain, window -> FFT -> bin power -> display levels
+ -> image rows, as one template. soundView draws its columns with the
+ kiss_fft_scalar instantiation on the FFT plans, -D runs the same stages
+ in double.
+ */
+
+#include <algorithm>
+
+#include "spectrumPipeline.h"
+#include "melFilterbank.h"
+
+template <typename T>
+spectrumPipeline<T>::spectrumPipeline(int _nfft, int _nbins, int nrows, specMapMode mode,
+                                      windowType type) :
+    nfft(_nfft), nbins(_nbins), fft(_nfft), window(_nfft, type), bank(NULL),
+    rowMap(_nbins, nrows, mode), frames((size_t)_nfft * PIPELINE_BATCH), spec(_nfft / 2 + 1),
+    powers(_nbins), bands(_nbins), levels(_nbins)
+{
+} /* spectrumPipeline::spectrumPipeline */
+
+template <typename T>
+void
+spectrumPipeline<T>::setRange(float floor_db, float max_db, float offset_db)
+{
+    quantizer.setRange(floor_db, max_db, offset_db);
+} /* spectrumPipeline::setRange */
+
+template <typename T>
+void
+spectrumPipeline<T>::setBank(const melFilterbank* _bank)
+{
+    bank = _bank;
+} /* spectrumPipeline::setBank */
+
+template <typename T>
+void
+spectrumPipeline<T>::spectrum(const T* ring, int start, cpx_type* out)
+{
+    // the window is applied as the FFT loads the ring
+    fft.windowed(ring, start, window.table(), out, nbins);
+} /* spectrumPipeline::spectrum */
+
+template <typename T>
+void
+spectrumPipeline<T>::spectra(const T* signal, int hop, int nframes, cpx_type* out)
+{
+    const int half = nfft / 2 + 1;
+    for (int f = 0; f < nframes; f += PIPELINE_BATCH) {
+        const int n = std::min(PIPELINE_BATCH, nframes - f);
+        for (int k = 0; k < n; k++)
+            window.apply(&frames[(size_t)k * nfft], signal + (size_t)(f + k) * hop);
+        fft.batch(&frames[0], out + (size_t)f * half, n);
+    }
+} /* spectrumPipeline::spectra */
+
+/*
+ * Level k starts at a fixed power, so the levels are found by comparing
+ * each power with the thresholds of the range instead of taking
+ * 20log10|X|. The thresholds are exact for float powers; a double power
+ * is rounded to float first, which can only move a level that sits on a
+ * threshold.
+ */
+template <typename T>
+float
+spectrumPipeline<T>::rows(const cpx_type* in, float* mag)
+{
+    // 0Hz set to 0
+    powers[0] = 0;
+    for (int i = 1; i < nbins; i++)
+        powers[i] = power(in[i]);
+
+    const float* p = &powers[0];
+    if (bank) {
+        // rows on the mel/Bark scale, the bands are quantized like bins
+        bank->apply(p, &bands[0]);
+        p = &bands[0];
+    }
+
+    int max_level = 0;
+    for (int i = 0; i < nbins; i++) {
+        int level = quantizer.level(p[i]);
+        levels[i] = level;
+        max_level = std::max(max_level, level);
+    }
+    rowMap.apply(&levels[0], mag);
+    return max_level;
+} /* spectrumPipeline::rows */
+
+template <typename T>
+float
+spectrumPipeline<T>::process(const T* frame, float* mag)
+{
+    spectrum(frame, 0, &spec[0]);
+    return rows(&spec[0], mag);
+} /* spectrumPipeline::process */
+
+template class spectrumPipeline<kiss_fft_scalar>;
+template class spectrumPipeline<double>;
@@ -0,0 +1,223 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: spectrumPipeline.h
+ Description:
+ Spectogram analysis chain, window -> FFT -> bin power -> display levels
+ -> image rows, as one template. soundView draws its columns with the
+ kiss_fft_scalar instantiation on the FFT plans, -D runs the same stages
+ in double.
+ */
+
+#ifndef SPECTRUMPIPELINE_H
+#define SPECTRUMPIPELINE_H
+
+#include <vector>
+#include <complex>
+#include <memory>
+#include <iostream>
+#include <stdlib.h>
+
+#include "kissfft.hh"
+#include "fftPlan.h"
+#include "windowContext.h"
+#include "levelQuantizer.h"
+#include "specMap.h"
+
+class melFilterbank;
+
+// Frame size of the spectogram (2 * BUFFER_LEN), the one transformed by
+// kissfft_fixed
+#define PIPELINE_FIXED_NFFT 1024
+
+// Frames windowed and transformed per batch call of spectrumPipeline::spectra
+#define PIPELINE_BATCH 16
+
+// Forward real FFT of the pipeline. The generic one is the templated
+// kissfft on a zero imaginary part, or for the spectogram frame size the
+// compile time sized kissfft_fixed.
+template <typename T>
+class pipelineFFT
+{
+public:
+    typedef std::complex<T> cpx_type;
+
+    // the runtime kissfft and its twiddles only for sizes kissfft_fixed
+    // does not cover
+    explicit pipelineFFT(int nfft) : buf(nfft), full(nfft), fixed(fixedTransform(nfft))
+    {
+        if (!fixed)
+            fft.reset(new kissfft<T>(nfft, false));
+    }
+
+    // nfft bins of the frame, freqdata holds nfft values
+    void forward(const T* timedata, cpx_type* freqdata)
+    {
+        for (size_t n = 0; n < buf.size(); n++)
+            buf[n] = cpx_type(timedata[n], 0);
+        if (fixed)
+            fixed(&buf[0], freqdata);
+        else
+            fft->transform(&buf[0], freqdata);
+    }
+
+    // The nbins lowest bins of the nfft samples of ring from ring[start]
+    // on, wrapping around, times window
+    void windowed(const T* ring, int start, const T* window, cpx_type* freqdata, int nbins)
+    {
+        const int nfft = (int)buf.size();
+        for (int k = 0, j = start; k < nfft; k++, j = j + 1 == nfft ? 0 : j + 1)
+            buf[k] = cpx_type(ring[j] * window[k], 0);
+        if (fixed)
+            fixed(&buf[0], &full[0]);
+        else
+            fft->transform(&buf[0], &full[0]);
+        std::copy(full.begin(), full.begin() + nbins, freqdata);
+    }
+
+    // nframes frames of nfft samples one after the other, nfft/2+1 bins
+    // of each one after the other
+    void batch(const T* timedata, cpx_type* freqdata, int nframes)
+    {
+        const int nfft = (int)buf.size();
+        for (int f = 0; f < nframes; f++) {
+            forward(timedata + (size_t)f * nfft, &full[0]);
+            std::copy(full.begin(), full.begin() + nfft / 2 + 1, freqdata + (size_t)f * (nfft / 2 + 1));
+        }
+    }
+
+    static T power(const cpx_type& c) { return std::norm(c); }
+
+private:
+    typedef void (*fixedFn)(const cpx_type*, cpx_type*);
+
+    // kissfft_fixed of nfft when it is instantiated for that size, else NULL
+    static fixedFn fixedTransform(int nfft)
+    {
+        return nfft == PIPELINE_FIXED_NFFT ? &kissfft_fixed<T, PIPELINE_FIXED_NFFT>::transform : NULL;
+    }
+
+    std::unique_ptr<kissfft<T> > fft;
+    std::vector<cpx_type> buf, full;
+    fixedFn fixed;
+};
+
+// kiss_fft_scalar goes through the real FFT plans, float in the float
+// build and int16 in the fixed one
+template <>
+class pipelineFFT<kiss_fft_scalar>
+{
+public:
+    typedef kiss_fft_cpx cpx_type;
+
+    explicit pipelineFFT(int nfft) : plan(fftPlan::get(nfft, false))
+    {
+        if (!plan) {
+            std::cerr << "[Error] Not enough memory!" << std::endl;
+            exit(-1);
+        }
+    }
+
+    void forward(const kiss_fft_scalar* timedata, cpx_type* freqdata)
+    {
+        plan->forward(timedata, freqdata);
+    }
+#ifndef FIXED_POINT
+    // std::complex<float> has the layout of kiss_fft_cpx
+    void forward(const float* timedata, std::complex<float>* freqdata)
+    {
+        plan->forward(timedata, (kiss_fft_cpx*)freqdata);
+    }
+#endif
+    void windowed(const kiss_fft_scalar* ring, int start, const kiss_fft_scalar* window,
+                  cpx_type* freqdata, int nbins)
+    {
+        plan->windowed(ring, start, window, freqdata, nbins);
+    }
+    void batch(const kiss_fft_scalar* timedata, cpx_type* freqdata, int nframes)
+    {
+        plan->batch(timedata, freqdata, nframes, plan->size(), plan->size() / 2 + 1);
+    }
+
+    // Squared magnitude of a bin; the int16 products of the fixed build
+    // are summed unsigned, a full scale bin does not fit an int
+    static float power(const cpx_type& c)
+    {
+#ifdef FIXED_POINT
+        return (float)((unsigned int)(c.r * c.r) + (unsigned int)(c.i * c.i));
+#else
+        return c.r * c.r + c.i * c.i;
+#endif
+    }
+
+private:
+    fftr_plan plan;
+};
+
+template <typename T>
+class spectrumPipeline
+{
+public:
+    typedef typename pipelineFFT<T>::cpx_type cpx_type;
+
+    // Frames of nfft samples, the lowest nbins bins are drawn on nrows
+    // image rows, mapped by mode
+    spectrumPipeline(int nfft, int nbins, int nrows, specMapMode mode = SPECMAP_INTERPOLATE,
+                     windowType type = WINDOW_KAISER);
+
+    int bins() const { return nbins; }
+    const windowContext<T>& windowing() const { return window; }
+
+    // dB range of the display levels, [floor_db, max_db] to 0..255.
+    // offset_db is added to 10log10 of a bin power first, for spectra not
+    // on the float FFT scale.
+    void setRange(float floor_db, float max_db, float offset_db = 0);
+
+    // Mel/Bark rows: the bin powers go through bank (nbins bins to nbins
+    // bands) before the levels. NULL, the default, draws the bins.
+    void setBank(const melFilterbank* bank);
+
+    // Window and FFT stage: the nbins lowest bins of the nfft samples of
+    // ring from ring[start] on, wrapping around
+    void spectrum(const T* ring, int start, cpx_type* spec);
+
+    // Window and FFT stage for a run of frames, frame f starts at
+    // signal + f*hop. All nfft/2+1 bins of frame f go to spec + f*(nfft/2+1).
+    void spectra(const T* signal, int hop, int nframes, cpx_type* spec);
+
+    // Power, levels and rows of the nbins bins of spec: mag receives the
+    // nrows display levels in 0..255. Returns the largest level.
+    float rows(const cpx_type* spec, float* mag);
+
+    // The whole chain on one frame of nfft samples
+    float process(const T* frame, float* mag);
+
+    static float power(const cpx_type& c) { return (float)pipelineFFT<T>::power(c); }
+
+private:
+    int nfft, nbins;
+    pipelineFFT<T> fft;
+    windowContext<T> window;
+    levelQuantizer quantizer;
+    const melFilterbank* bank;
+    specMap rowMap;
+    std::vector<T> frames;                  // PIPELINE_BATCH windowed frames
+    std::vector<cpx_type> spec;
+    std::vector<float> powers, bands, levels;
+};
+
+#endif
@@ -0,0 +1,217 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: windowContext.cpp
+ Description:
+ Analysis window table owned by each analyzer, so analyzers on different
+ threads or with different frame sizes share no state.
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <string.h>
+#include <math.h>
+
+#include "windowContext.h"
+#include "windowTables.h"
+#include "common.h"
+
+using namespace std;
+
+static double
+besseli0 (double x)
+{
+	/*
+	** Power series of I0, sum of ((x/2)^k / k!)^2. Each term comes from
+	** the previous one, no factorial table needed.
+	*/
+	double term = 1.0, result = 1.0 ;
+	double quarter_x2 = 0.25 * x * x ;
+
+	for (int k = 1 ; k < 64 ; k++) {
+		term *= quarter_x2 / ((double) k * k) ;
+		result += term ;
+		if (term < result * 1e-17)
+			break ;
+	} ;
+
+	return result ;
+} /* besseli0 */
+
+static void
+calc_kaiser_window (double* data, int datalen, double beta)
+{
+	/*
+	**			besseli0 (beta * sqrt (1- (2*x/N).^2))
+	** w (x) =	--------------------------------------,  -N/2 <= x <= N/2
+	**				   besseli0 (beta)
+	*/
+
+	double two_n_on_N, denom ;
+	int k ;
+
+	denom = besseli0 (beta) ;
+
+	if (! isfinite (denom)) {
+		printf ("besseli0 (%f) : %f\nExiting\n", beta, denom) ;
+		exit (1) ;
+	} ;
+
+	// symmetric, the upper half is a mirror
+	for (k = 0 ; k < (datalen + 1) / 2 ; k++) {
+		double n = k + 0.5 - 0.5 * datalen ;
+		two_n_on_N = (2.0 * n) / datalen ;
+		data [k] = data [datalen - 1 - k] =
+			besseli0 (beta * sqrt (1.0 - two_n_on_N * two_n_on_N)) / denom ;
+	} ;
+
+	return ;
+} /* calc_kaiser_window */
+
+static void
+calc_cosine_window (double* data, int datalen, const double a [4])
+{
+	/*
+	**	a0 - a1 cos (x) + a2 cos (2x) - a3 cos (3x),  x = 2 pi k / (N - 1)
+	**
+	**	Hann, Nuttall and Blackman-Harris, as calc_nuttall_window in
+	**	sample/window.c.
+	*/
+	int k ;
+
+	for (k = 0 ; k < (datalen + 1) / 2 ; k++) {
+		double scale = datalen > 1 ? 2.0 * M_PI * k / (datalen - 1) : 0 ;
+		data [k] = data [datalen - 1 - k] =
+			a [0] - a [1] * cos (scale) + a [2] * cos (2.0 * scale) - a [3] * cos (3.0 * scale) ;
+	} ;
+
+	return ;
+} /* calc_cosine_window */
+
+static void
+calc_window (double* data, int datalen, windowType type, double beta)
+{
+	static const double hann [4] = { 0.5, 0.5, 0, 0 } ;
+	static const double nuttall [4] = { 0.355768, 0.487396, 0.144232, 0.012604 } ;
+	static const double blackman_harris [4] = { 0.35875, 0.48829, 0.14128, 0.01168 } ;
+
+	switch (type) {
+		case WINDOW_KAISER :
+			calc_kaiser_window (data, datalen, beta) ;
+			break ;
+		case WINDOW_HANN :
+			calc_cosine_window (data, datalen, hann) ;
+			break ;
+		case WINDOW_NUTTALL :
+			calc_cosine_window (data, datalen, nuttall) ;
+			break ;
+		case WINDOW_BLACKMAN_HARRIS :
+			calc_cosine_window (data, datalen, blackman_harris) ;
+			break ;
+	} ;
+} /* calc_window */
+
+// The compile time table, if there is one for these parameters
+static const float*
+precomputed (windowType type, int size, double beta)
+{
+	if (type == WINDOW_KAISER && beta != 20.0)
+		return NULL ;
+	return windowTable (type, size) ;
+} /* precomputed */
+
+template <typename T>
+windowContext<T>::windowContext(int size, windowType type, double beta) :
+    wtype(type), window(size)
+{
+    if (size <= 0) {
+        cerr << "[Error] Window size must be positive." << endl;
+        exit(-1);
+    }
+
+    // the tables are float, double precision runs compute their own
+    const float* table = sizeof(T) == sizeof(float) ? precomputed(type, size, beta) : NULL;
+    if (table) {
+        std::copy(table, table + size, window.begin());
+        return;
+    }
+
+    std::vector<double> w(size);
+    calc_window(&w[0], size, type, beta);
+    for (int k = 0; k < size; k++)
+        window[k] = (T) w[k];
+} /* windowContext::windowContext */
+
+template <>
+windowContext<short>::windowContext(int size, windowType type, double beta) :
+    wtype(type), window(size)
+{
+    if (size <= 0) {
+        cerr << "[Error] Window size must be positive." << endl;
+        exit(-1);
+    }
+
+    // Same window as the float version, stored in Q15
+    const float* table = precomputed(type, size, beta);
+    std::vector<double> w(size);
+    if (table)
+        std::copy(table, table + size, w.begin());
+    else
+        calc_window(&w[0], size, type, beta);
+    for (int k = 0; k < size; k++)
+        window[k] = (short) MIN(32767, lrint(w[k] * 32768));
+} /* windowContext<short>::windowContext */
+
+bool
+windowTypeFromName(const char* name, windowType& type)
+{
+    if (strcmp(name, "kaiser") == 0)
+        type = WINDOW_KAISER;
+    else if (strcmp(name, "hann") == 0)
+        type = WINDOW_HANN;
+    else if (strcmp(name, "nuttall") == 0)
+        type = WINDOW_NUTTALL;
+    else if (strcmp(name, "blackmanharris") == 0)
+        type = WINDOW_BLACKMAN_HARRIS;
+    else
+        return false;
+    return true;
+} /* windowTypeFromName */
+
+template <typename T>
+void
+windowContext<T>::apply(T* out, const T* data) const
+{
+    const T* w = &window[0];
+    const int n = size();
+    for (int k = 0; k < n; k++)
+        out[k] = data[k] * w[k];
+} /* windowContext::apply */
+
+template <>
+void
+windowContext<short>::apply(short* out, const short* data) const
+{
+    const short* w = &window[0];
+    const int n = size();
+    for (int k = 0; k < n; k++)
+        out[k] = (short) ((data[k] * w[k] + (1 << 14)) >> 15);
+} /* windowContext<short>::apply */
+
+template class windowContext<float>;
+template class windowContext<double>;
+template class windowContext<short>;
@@ -0,0 +1,60 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: windowContext.h
+ Description:
+ Analysis window table owned by each analyzer, so analyzers on different
+ threads or with different frame sizes share no state.
+ */
+
+#ifndef WINDOWCONTEXT_H
+#define WINDOWCONTEXT_H
+
+#include <vector>
+
+enum windowType {
+    WINDOW_KAISER = 0,          // beta = 20 unless given, the default
+    WINDOW_HANN,
+    WINDOW_NUTTALL,
+    WINDOW_BLACKMAN_HARRIS      // 4 term, -92dB side lobes
+};
+
+// kaiser, hann, nuttall or blackmanharris, false for other names
+bool windowTypeFromName(const char* name, windowType& type);
+
+template <typename T>
+class windowContext
+{
+public:
+    // A window of size points, copied from the compile time tables for
+    // 512, 1024 and 2048 points, computed here for other sizes. beta is
+    // the Kaiser shape parameter.
+    windowContext(int size, windowType type = WINDOW_KAISER, double beta = 20.0);
+
+    int size() const { return (int)window.size(); }
+    windowType type() const { return wtype; }
+    const T* table() const { return &window[0]; }
+
+    // out = data * window, size() samples, out may be data
+    void apply(T* out, const T* data) const;
+
+private:
+    windowType wtype;
+    std::vector<T> window;  // in Q15 for short
+};
+
+#endif
@@ -0,0 +1,172 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: windowTables.cpp
+ Description:
+ Window tables for the common frame sizes, generated at compile time.
+ */
+
+#include <stddef.h>
+#include <array>
+
+#include "windowTables.h"
+
+namespace {
+
+//
+// C++11 constexpr functions are a single return statement, so the math
+// below is written as tail recursion. It only runs in the compiler.
+//
+constexpr double pi = 3.14159265358979323846;
+
+constexpr double
+sqrtNewton(double x, double g, int n)
+{
+    return n == 0 ? g : sqrtNewton(x, 0.5 * (g + x / g), n - 1);
+}
+
+// sqrt of 0..1, Newton from 1 converges within 16 steps from 1e-4 up
+constexpr double
+sqrtUnit(double x)
+{
+    return x <= 0 ? 0 : sqrtNewton(x, 1.0, 16);
+}
+
+constexpr double
+cosTaylor(double x2, double term, double sum, int k)
+{
+    return k > 40 ? sum : cosTaylor(x2, -term * x2 / ((k - 1) * k), sum - term * x2 / ((k - 1) * k), k + 2);
+}
+
+constexpr double
+cosFolded(double x)
+{
+    return cosTaylor(x * x, 1.0, 1.0, 2);
+}
+
+// cos of x >= 0, folded into -pi..pi first
+constexpr double
+cosine(double x)
+{
+    return cosFolded(x - 2 * pi * (long long)(x / (2 * pi) + 0.5));
+}
+
+// I0(x) as sum of ((x/2)^k / k!)^2, each term from the previous one
+constexpr double
+besselTerms(double quarter_x2, double term, double sum, int k)
+{
+    return term < sum * 1e-17 ? sum :
+           besselTerms(quarter_x2, term * quarter_x2 / ((double)k * k),
+                       sum + term * quarter_x2 / ((double)k * k), k + 1);
+}
+
+constexpr double
+besseli0(double x)
+{
+    return besselTerms(0.25 * x * x, 1.0, 1.0, 1);
+}
+
+constexpr double kaiserBeta = 20.0;
+
+// Same samples as calc_kaiser_window in windowContext.cpp
+constexpr double
+kaiser(int k, int len, double denom)
+{
+    return besseli0(kaiserBeta * sqrtUnit(1.0 - ((2.0 * k + 1.0 - len) / len) *
+                                                ((2.0 * k + 1.0 - len) / len))) / denom;
+}
+
+// a0 - a1 cos(x) + a2 cos(2x) - a3 cos(3x), x = 2 pi k / (len - 1)
+constexpr double
+cosineSum(int k, int len, double a0, double a1, double a2, double a3)
+{
+    return a0 - a1 * cosine(2 * pi * k / (len - 1))
+              + a2 * cosine(4 * pi * k / (len - 1))
+              - a3 * cosine(6 * pi * k / (len - 1));
+}
+
+constexpr double
+windowValue(windowType type, int k, int len)
+{
+    return type == WINDOW_KAISER  ? kaiser(k, len, besseli0(kaiserBeta)) :
+           type == WINDOW_HANN    ? cosineSum(k, len, 0.5, 0.5, 0, 0) :
+           type == WINDOW_NUTTALL ? cosineSum(k, len, 0.355768, 0.487396, 0.144232, 0.012604) :
+                                    cosineSum(k, len, 0.35875, 0.48829, 0.14128, 0.01168);
+}
+
+//
+// 0..N-1 as a parameter pack, built by halves so the template depth is
+// log2(N) and not N
+//
+template <int... I> struct indices {};
+
+template <class A, class B> struct concatIndices;
+template <int... I, int... J>
+struct concatIndices<indices<I...>, indices<J...> >
+{
+    typedef indices<I..., (int)sizeof...(I) + J...> type;
+};
+
+template <int N> struct makeIndices
+{
+    typedef typename concatIndices<typename makeIndices<N / 2>::type,
+                                   typename makeIndices<N - N / 2>::type>::type type;
+};
+template <> struct makeIndices<0> { typedef indices<> type; };
+template <> struct makeIndices<1> { typedef indices<0> type; };
+
+template <int... I>
+constexpr std::array<float, sizeof...(I)>
+generate(windowType type, indices<I...>)
+{
+    return {{ (float)windowValue(type, I, (int)sizeof...(I))... }};
+}
+
+template <windowType W, int N>
+struct table
+{
+    static constexpr std::array<float, N> data = generate(W, typename makeIndices<N>::type());
+};
+template <windowType W, int N>
+constexpr std::array<float, N> table<W, N>::data;
+
+template <windowType W>
+const float*
+lookup(int size)
+{
+    return size == 512  ? &table<W, 512>::data[0] :
+           size == 1024 ? &table<W, 1024>::data[0] :
+           size == 2048 ? &table<W, 2048>::data[0] : NULL;
+}
+
+}
+
+const float*
+windowTable(windowType type, int size)
+{
+    switch (type) {
+        case WINDOW_KAISER:
+            return lookup<WINDOW_KAISER>(size);
+        case WINDOW_HANN:
+            return lookup<WINDOW_HANN>(size);
+        case WINDOW_NUTTALL:
+            return lookup<WINDOW_NUTTALL>(size);
+        case WINDOW_BLACKMAN_HARRIS:
+            return lookup<WINDOW_BLACKMAN_HARRIS>(size);
+    }
+    return NULL;
+} /* windowTable */
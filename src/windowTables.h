@@ -0,0 +1,32 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: windowTables.h
+ Description:
+ Window tables for the common frame sizes, generated at compile time.
+ */
+
+#ifndef WINDOWTABLES_H
+#define WINDOWTABLES_H
+
+#include "windowContext.h"
+
+// The precomputed table of a window type and size (512, 1024 or 2048
+// points, Kaiser with beta = 20), or NULL when there is none.
+const float* windowTable(windowType type, int size);
+
+#endif
@@ -0,0 +1,147 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: zoomFFT.cpp
+ Description:
+ Chirp-z (Bluestein) zoom spectrum, any number of bins across an
+ arbitrary frequency band.
+
+ The bins f_m = f0 + m df, with W = e^(-j2pi df/fs), are
+     X_m = sum_n x_n e^(-j2pi f0 n/fs) W^(nm)
+ and nm = (n^2 + m^2 - (m-n)^2)/2 turns this into
+     X_m = W^(m^2/2) sum_n (x_n e^(-j2pi f0 n/fs) W^(n^2/2)) W^(-(m-n)^2/2)
+ a convolution with a chirp, done as FFTs of a fast size of at least
+ nfft + nbins - 1 points. The cost is two such FFTs per frame whatever
+ the band, where a plain FFT reaching the same bin spacing needs
+ fs/df points. The bins interpolate the spectrum of the window, so
+ the frequency resolution is still set by the nfft sample window.
+ */
+
+#include <iostream>
+#include <algorithm>
+#include <math.h>
+
+#include "zoomFFT.h"
+
+using namespace std;
+
+namespace {
+
+// e^(j pi c k^2) with the phase reduced in double first, k^2 gets large
+std::complex<float>
+chirp(double c, long k)
+{
+    double phase = fmod(c * (double)k * (double)k, 2.0) * M_PI;
+    return std::complex<float>((float)cos(phase), (float)sin(phase));
+}
+
+// Plain complex product, std::complex's operator* goes through the
+// NaN/inf aware __mulsc3 and is many times slower
+inline std::complex<float>
+cmul(const std::complex<float>& a, const std::complex<float>& b)
+{
+    return std::complex<float>(a.real() * b.real() - a.imag() * b.imag(),
+                               a.real() * b.imag() + a.imag() * b.real());
+}
+
+}
+
+zoomFFT::zoomFFT(int _nfft, int _nbins, double f0, double f1, double sampleRate) :
+    nfft(_nfft), nbins(_nbins),
+    nconv(kiss_fft_next_fast_size(_nfft + _nbins - 1)),
+    pre(_nfft), post(_nbins), filter(nconv), work(nconv), spec(nconv)
+#ifdef FIXED_POINT
+    , fwd(nconv, false), inv(nconv, true)
+#endif
+{
+    const double df = nbins > 1 ? (f1 - f0) / (nbins - 1) : 0;
+    // W^(k^2/2) = e^(-j pi (df/fs) k^2)
+    const double c = df / sampleRate;
+
+    for (int n = 0; n < nfft; n++) {
+        double phase = -2 * M_PI * fmod(f0 / sampleRate * n, 1.0);
+        pre[n] = chirp(-c, n) * cpx((float)cos(phase), (float)sin(phase));
+    }
+    for (int m = 0; m < nbins; m++)
+        post[m] = chirp(-c, m);
+
+#ifndef FIXED_POINT
+    fwd = kiss_fft_alloc(nconv, 0, NULL, NULL);
+    inv = kiss_fft_alloc(nconv, 1, NULL, NULL);
+    if (fwd == NULL || inv == NULL) {
+        cerr << "[Error] Not enough memory!" << endl;
+        exit(-1);
+    }
+#endif
+
+    // W^(-k^2/2) for k = -(nfft-1) .. nbins-1, wrapped around nconv
+    for (int k = 0; k < nconv; k++)
+        work[k] = 0;
+    for (int k = 0; k < nbins; k++)
+        work[k] = chirp(c, k);
+    for (int k = 1; k < nfft; k++)
+        work[nconv - k] = chirp(c, k);
+    fft(&work[0], &filter[0], false);
+    for (int k = 0; k < nconv; k++)
+        filter[k] /= (float)nconv;
+} /* zoomFFT::zoomFFT */
+
+zoomFFT::~zoomFFT()
+{
+#ifndef FIXED_POINT
+    kiss_fft_free(fwd);
+    kiss_fft_free(inv);
+#endif
+} /* zoomFFT::~zoomFFT */
+
+void
+zoomFFT::fft(const cpx* in, cpx* out, bool inverse)
+{
+#ifdef FIXED_POINT
+    (inverse ? inv : fwd).transform(in, out);
+#else
+    // std::complex<float> and kiss_fft_cpx share the {re, im} layout
+    kiss_fft(inverse ? inv : fwd, (const kiss_fft_cpx*)in, (kiss_fft_cpx*)out);
+#endif
+} /* zoomFFT::fft */
+
+void
+zoomFFT::transform(const kiss_fft_scalar* windowed, kiss_fft_cpx* out)
+{
+    for (int n = 0; n < nfft; n++)
+        work[n] = pre[n] * (float)windowed[n];
+    for (int n = nfft; n < nconv; n++)
+        work[n] = 0;
+
+    fft(&work[0], &spec[0], false);
+    for (int k = 0; k < nconv; k++)
+        spec[k] = cmul(spec[k], filter[k]);
+    fft(&spec[0], &work[0], true);
+
+    for (int m = 0; m < nbins; m++) {
+        cpx x = cmul(post[m], work[m]);
+#ifdef FIXED_POINT
+        // fixed point kiss_fftr output is scaled by 1/nfft
+        x /= (float)nfft;
+        out[m].r = (kiss_fft_scalar)std::max(-32768.f, std::min(32767.f, x.real()));
+        out[m].i = (kiss_fft_scalar)std::max(-32768.f, std::min(32767.f, x.imag()));
+#else
+        out[m].r = x.real();
+        out[m].i = x.imag();
+#endif
+    }
+} /* zoomFFT::transform */
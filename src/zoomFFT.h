@@ -0,0 +1,69 @@
+/*
+ soundScore -- Sound Spectogram anaylize and scoring tool
+ Copyright (C) 2014 copyright Shen Yiming <sym@shader.cn>
+
+ This program is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ File Name: zoomFFT.h
+ Description:
+ Chirp-z (Bluestein) zoom spectrum, any number of bins across an
+ arbitrary frequency band.
+ */
+
+#ifndef ZOOMFFT_H
+#define ZOOMFFT_H
+
+#include <vector>
+#include <complex>
+
+// kissFFT addon include file
+#include "kiss_fft.h"
+#ifdef FIXED_POINT
+#include "kissfft.hh"
+#endif
+
+class zoomFFT
+{
+public:
+    // nbins bins evenly spaced from f0 to f1 Hz (both included), over
+    // frames of nfft samples at sampleRate
+    zoomFFT(int nfft, int nbins, double f0, double f1, double sampleRate);
+    ~zoomFFT();
+
+    int size() const { return nbins; }
+
+    // nfft windowed samples to nbins bins, scaled like kiss_fftr output
+    void transform(const kiss_fft_scalar* windowed, kiss_fft_cpx* out);
+
+private:
+    zoomFFT(const zoomFFT&) = delete;
+    zoomFFT& operator=(const zoomFFT&) = delete;
+
+    typedef std::complex<float> cpx;
+    void fft(const cpx* in, cpx* out, bool inverse);
+
+    int nfft, nbins, nconv;
+    std::vector<cpx> pre;       // e^(-j2pi f0 n/fs) W^(n^2/2), n < nfft
+    std::vector<cpx> post;      // W^(m^2/2), m < nbins
+    std::vector<cpx> filter;    // spectrum of the W^(-k^2/2) chirp, 1/nconv folded in
+    std::vector<cpx> work, spec;
+#ifdef FIXED_POINT
+    // kiss_fft is int16 in this build, the chirps need float precision
+    kissfft<float> fwd, inv;
+#else
+    kiss_fft_cfg fwd, inv;
+#endif
+};
+
+#endif